@@ -45,19 +45,36 @@ macro(fetch_library NAME URL TAG)
   endif()
 endmacro()
 
+if(BUILD_TESTS OR BUILD_BENCHMARKS)
+  fetch_library(doctest https://github.com/doctest/doctest.git v2.4.11)
+
+  file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/doctest_main.cpp "#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN\n#include <doctest/doctest.h>\n")
+  add_library(doctest_main ${CMAKE_CURRENT_BINARY_DIR}/doctest_main.cpp)
+  target_link_libraries(doctest_main PUBLIC doctest::doctest)
+endif()
+
 if(BUILD_TESTS)
   include(CTest)
-  fetch_library(doctest https://github.com/doctest/doctest.git v2.4.11)
   include(doctest)
 
   fetch_library(trompeloeil https://github.com/rollbear/trompeloeil.git v48)
+endif()
 
-  file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/doctest_main.cpp "#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN\n#include <doctest/doctest.h>\n")
-  add_library(doctest_main ${CMAKE_CURRENT_BINARY_DIR}/doctest_main.cpp)
-  target_link_libraries(doctest_main PUBLIC doctest::doctest)
+if(BUILD_BENCHMARKS)
+  fetch_library(nanobench https://github.com/martinus/nanobench.git v4.3.11)
+  if(NOT TARGET nanobench::nanobench)
+    add_library(nanobench::nanobench ALIAS nanobench)
+  endif()
+
+  file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/nanobench_main.cpp "#define ANKERL_NANOBENCH_IMPLEMENT\n#include <nanobench.h>\n")
+  add_library(nanobench_main ${CMAKE_CURRENT_BINARY_DIR}/nanobench_main.cpp)
+  target_link_libraries(nanobench_main PUBLIC nanobench::nanobench)
 endif()
 
 if (BUILD_BACKEND_SERVER)
   find_package(Boost REQUIRED)
+  # Every server session keeps several coroutine frames and socket operations alive at once,
+  # so asio recycles all of them per thread instead of hitting the heap on every request
+  target_compile_definitions(boost::boost INTERFACE BOOST_ASIO_RECYCLING_ALLOCATOR_CACHE_SIZE=8)
   find_package(reflectcpp REQUIRED)
 endif()
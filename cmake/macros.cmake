@@ -1,7 +1,7 @@
 
 macro(tq_parse_arguments)
   set(TQ_LIBRARY_OPTIONS ADD_TESTS ADD_TESTS_WITH_MOCK)
-  set(TQ_LIBRARY_VALUES TARGET_NAME)
+  set(TQ_LIBRARY_VALUES TARGET_NAME TEST_FOLDER)
   set(TQ_LIBRARY_MULTI_VALUES SOURCES PRIVATE PUBLIC INTERFACE TEST_LIBS)
   cmake_parse_arguments(PARSED "${TQ_LIBRARY_OPTIONS}" "${TQ_LIBRARY_VALUES}" "${TQ_LIBRARY_MULTI_VALUES}" ${ARGN})
 endmacro()
@@ -39,6 +39,9 @@ function(tq_add_test_executable_in_ut_folder)
   tq_parse_arguments(${ARGN})
 
   set(TEST_DIR ${CMAKE_CURRENT_SOURCE_DIR}/ut)
+  if(PARSED_TEST_FOLDER)
+    set(TEST_DIR ${CMAKE_CURRENT_SOURCE_DIR}/${PARSED_TEST_FOLDER})
+  endif()
   if(NOT EXISTS ${TEST_DIR})
     message(FATAL_ERROR "${TEST_DIR} directory not found")
   endif()
@@ -65,6 +68,35 @@ function(tq_add_test_executable_in_ut_folder)
   doctest_discover_tests(${PARSED_TARGET_NAME})
 endfunction()
 
+function(tq_add_benchmark_executable_in_bench_folder)
+  if(NOT BUILD_BENCHMARKS)
+    return()
+  endif()
+
+  tq_parse_arguments(${ARGN})
+
+  set(BENCH_DIR ${CMAKE_CURRENT_SOURCE_DIR}/bench)
+  if(NOT EXISTS ${BENCH_DIR})
+    message(FATAL_ERROR "${BENCH_DIR} directory not found")
+  endif()
+  file(GLOB_RECURSE FILES ${BENCH_DIR}/*)
+  if (NOT FILES)
+    message(FATAL_ERROR "${BENCH_DIR} is empty")
+  endif()
+
+  tq_add_executable(
+    TARGET_NAME
+      ${PARSED_TARGET_NAME}
+    SOURCES
+      ${FILES}
+    PRIVATE
+      ${PARSED_PUBLIC}
+      ${PARSED_PRIVATE}
+      doctest_main
+      nanobench_main
+    )
+endfunction()
+
 function(tq_add_static_library)
   tq_parse_arguments(${ARGN})
   add_library(${PARSED_TARGET_NAME} STATIC ${PARSED_SOURCES})
@@ -17,6 +17,7 @@ endif(CCACHE)
 
 option(BUILD_TESTS "Build unit tests tree." OFF)
 option(BUILD_BACKEND_SERVER "Build backend server." OFF)
+option(BUILD_BENCHMARKS "Build benchmarks tree." OFF)
 
 if (DEFINED CONAN_INSTALL_ARGS)
     if (CMAKE_SYSTEM_NAME STREQUAL "Darwin")
@@ -31,4 +32,7 @@ if (DEFINED CONAN_ARGS)
     if (BUILD_BACKEND_SERVER)
         set(CONAN_ARGS "${CONAN_ARGS};-o just_queue_it/*:with_backend=True")
     endif()
+    if (BUILD_BENCHMARKS)
+        set(CONAN_ARGS "${CONAN_ARGS};-o just_queue_it/*:with_benchmarks=True")
+    endif()
 endif()
@@ -8,11 +8,15 @@ class JustQueueItConan(ConanFile):
 
     options = {
         "with_tests": [True, False],
-        "with_backend": [True, False]
+        "with_backend": [True, False],
+        "with_benchmarks": [True, False]
     }
     default_options = {
         "with_tests": False,
-        "with_backend": False
+        "with_backend": False,
+        "with_benchmarks": False,
+        "reflect-cpp/*:with_msgpack": True,
+        "reflect-cpp/*:with_cbor": True
     }
 
     def requirements(self):
@@ -24,3 +28,7 @@ class JustQueueItConan(ConanFile):
         if self.options.with_tests:
             self.test_requires("doctest/2.4.11")
             self.test_requires("trompeloeil/49")
+        if self.options.with_benchmarks:
+            if not self.options.with_tests:
+                self.test_requires("doctest/2.4.11")
+            self.test_requires("nanobench/4.3.11")
@@ -15,14 +15,45 @@
 //
 // Home page: https://github.com/Just-Queue-it/JustQueueIt/
 
-#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/queues_factory/queues_factory.hpp>
 #include <libraries/backend/server/server.hpp>
-#include <libraries/backend/tasks_manager/tasks_manager.hpp>
 
-int main()
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    /**
+     * @brief Storage is in-memory by default, `--wal <directory>` makes it durable with write-ahead log and snapshots in `directory`,
+     * `--combine` batches concurrent task creations through flat combining,
+     * `--max-attempts <count>` sets how many times a failed task is delivered before it is moved to dead letters,
+     * `--dedup-window <seconds>` sets how long creations with the same idempotency key return the task created first
+     */
+    backend::QueuesOptions ParseOptions(std::span<char*> args)
+    {
+        backend::QueuesOptions options{};
+        for (size_t i = 1; i < args.size(); ++i)
+        {
+            if (std::string_view{args[i]} == "--wal" && i + 1 < args.size())
+                options.wal_directory = args[++i];
+            else if (std::string_view{args[i]} == "--combine")
+                options.combine = true;
+            else if (std::string_view{args[i]} == "--max-attempts" && i + 1 < args.size())
+                options.retry_policy.max_attempts = static_cast<uint32_t>(std::stoul(args[++i]));
+            else if (std::string_view{args[i]} == "--dedup-window" && i + 1 < args.size())
+                options.dedup_policy.window = std::chrono::seconds{std::stoul(args[++i])};
+        }
+        return options;
+    }
+} // namespace
+
+int main(int argc, char** argv)
 {
-    backend::TasksManager tasks_manager{std::make_shared<backend::data_storage::InMemoryStorage>()};
-    const auto            server = backend::StartServer(tasks_manager, rest::ServerConfig{.port = 8080});
+    const auto queues_manager = backend::MakeQueuesManager(ParseOptions({argv, static_cast<size_t>(argc)}));
+    const auto server         = backend::StartServer(queues_manager, rest::ServerConfig{.port = 8080});
     server.Wait();
     return 0;
 }
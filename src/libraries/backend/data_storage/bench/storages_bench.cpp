@@ -0,0 +1,260 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <libraries/backend/data_storage/combining_storage/combining_storage.hpp>
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/data_storage/sharded_storage/sharded_storage.hpp>
+#include <libraries/backend/data_storage/wal_storage/wal_storage.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ops_per_thread = 10'000;
+    constexpr size_t prefilled      = 100'000;
+    constexpr size_t epochs         = 5;
+
+    /**
+     * @brief Queue capacity holding every task created by all epochs of a bench, as tasks are never dequeued there
+     */
+    constexpr size_t CreatedTasksCapacity(size_t threads_count)
+    {
+        return threads_count * ops_per_thread * epochs;
+    }
+
+    void RunInThreads(size_t threads_count, const std::function<void(size_t)>& fn)
+    {
+        std::vector<std::jthread> threads{};
+        for (size_t i = 0; i < threads_count; ++i)
+            threads.emplace_back(fn, i);
+    }
+
+    ankerl::nanobench::Bench MakeBench(const std::string& title, size_t threads_count)
+    {
+        ankerl::nanobench::Bench bench{};
+        bench.title(title + ", " + std::to_string(threads_count) + " threads")
+            .unit("task")
+            .batch(threads_count * ops_per_thread)
+            .epochs(epochs)
+            .epochIterations(1)
+            .relative(true);
+        return bench;
+    }
+
+    template<typename TStorage>
+    void BenchCreate(ankerl::nanobench::Bench& bench, const std::string& name, size_t threads_count)
+    {
+        TStorage storage{};
+        bench.run(name, [&] {
+            RunInThreads(threads_count, [&](size_t) {
+                for (size_t i = 0; i < ops_per_thread; ++i)
+                    ankerl::nanobench::doNotOptimizeAway(storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"}));
+            });
+        });
+    }
+
+    template<typename TStorage>
+    void BenchGet(ankerl::nanobench::Bench& bench, const std::string& name, size_t threads_count)
+    {
+        TStorage storage{};
+        for (size_t i = 0; i < prefilled; ++i)
+            storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"});
+
+        bench.run(name, [&] {
+            RunInThreads(threads_count, [&](size_t thread) {
+                for (size_t i = 0; i < ops_per_thread; ++i)
+                    ankerl::nanobench::doNotOptimizeAway(storage.GetTask((thread * ops_per_thread + i * 7919) % prefilled));
+            });
+        });
+    }
+} // namespace
+
+TEST_CASE("CreateTask throughput by threads count")
+{
+    for (const size_t threads_count : {1, 2, 4, 8, 16})
+    {
+        auto bench = MakeBench("CreateTask", threads_count);
+        BenchCreate<backend::data_storage::InMemoryStorage>(bench, "InMemoryStorage", threads_count);
+        BenchCreate<backend::data_storage::ShardedStorage>(bench, "ShardedStorage", threads_count);
+    }
+}
+
+TEST_CASE("CreateTask throughput under contention, combining vs locking")
+{
+    const auto bench_create = [](ankerl::nanobench::Bench& bench, const std::string& name, size_t threads_count, backend::DataStorage&& storage) {
+        bench.run(name, [&] {
+            RunInThreads(threads_count, [&](size_t) {
+                for (size_t i = 0; i < ops_per_thread; ++i)
+                    ankerl::nanobench::doNotOptimizeAway(storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"}));
+            });
+        });
+    };
+
+    // Single-shard ShardedStorage is the plain std::shared_mutex path: every call takes the same lock
+    for (const size_t threads_count : {1, 4, 16, 64})
+    {
+        const auto capacity = CreatedTasksCapacity(threads_count);
+        auto       bench    = MakeBench("CreateTask contention", threads_count);
+        bench_create(bench, "ShardedStorage, 1 shard", threads_count, backend::data_storage::ShardedStorage{1, capacity});
+        bench_create(bench, "CombiningStorage over ShardedStorage, 1 shard", threads_count, backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::ShardedStorage>(1, capacity)});
+        bench_create(bench, "InMemoryStorage", threads_count, backend::data_storage::InMemoryStorage{capacity});
+        bench_create(bench, "CombiningStorage over InMemoryStorage", threads_count, backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>(capacity)});
+    }
+}
+
+TEST_CASE("WalStorage CreateTask throughput by flush interval")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "storages_bench_wal";
+    for (const size_t threads_count : {1, 8, 64})
+    {
+        auto bench = MakeBench("WalStorage CreateTask", threads_count);
+        for (const auto flush_interval : {std::chrono::microseconds{0}, std::chrono::microseconds{100}, std::chrono::microseconds{1000}})
+        {
+            std::filesystem::remove_all(directory);
+            backend::data_storage::WalStorage storage{std::make_unique<backend::data_storage::ShardedStorage>(backend::data_storage::ShardedStorage::default_shards_count, CreatedTasksCapacity(threads_count)), {.directory = directory, .flush_interval = flush_interval, .max_batch_size = threads_count}};
+            bench.run("flush interval " + std::to_string(flush_interval.count()) + "us", [&] {
+                RunInThreads(threads_count, [&](size_t) {
+                    for (size_t i = 0; i < ops_per_thread; ++i)
+                        ankerl::nanobench::doNotOptimizeAway(storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"}));
+                });
+            });
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("CreateTasks throughput by batch size")
+{
+    constexpr size_t tasks_count = 16'384;
+
+    const auto bench_batches = []<typename TStorage>(ankerl::nanobench::Bench& bench, const std::string& name, size_t batch_size, TStorage&& storage) {
+        const std::vector<backend::TaskPayload> payloads(batch_size, backend::TaskPayload{.name = "name", .description = "description"});
+        bench.run(name + ", batch " + std::to_string(batch_size), [&] {
+            for (size_t i = 0; i < tasks_count; i += batch_size)
+                ankerl::nanobench::doNotOptimizeAway(storage.CreateTasks(payloads));
+        });
+    };
+
+    // Throughput stops growing once per-call overhead (lock, WAL record and fsync wait) is amortized, that batch size is the useful upper bound for clients
+    const auto directory = std::filesystem::temp_directory_path() / "storages_bench_wal";
+    ankerl::nanobench::Bench bench{};
+    bench.title("CreateTasks by batch size").unit("task").batch(tasks_count).epochs(5).epochIterations(1);
+    for (const size_t batch_size : {1, 4, 16, 64, 256, 1024, 4096})
+    {
+        bench_batches(bench, "InMemoryStorage", batch_size, backend::data_storage::InMemoryStorage{});
+        bench_batches(bench, "ShardedStorage", batch_size, backend::data_storage::ShardedStorage{});
+
+        std::filesystem::remove_all(directory);
+        bench_batches(bench, "WalStorage", batch_size, backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), {.directory = directory}});
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("GetTask throughput by threads count")
+{
+    for (const size_t threads_count : {1, 2, 4, 8, 16})
+    {
+        auto bench = MakeBench("GetTask", threads_count);
+        BenchGet<backend::data_storage::InMemoryStorage>(bench, "InMemoryStorage", threads_count);
+        BenchGet<backend::data_storage::ShardedStorage>(bench, "ShardedStorage", threads_count);
+    }
+}
+
+TEST_CASE("CreateTask latency by count of concurrent readers")
+{
+    constexpr size_t creates = 20'000;
+
+    const auto bench_mixed = []<typename TStorage>(ankerl::nanobench::Bench& bench, const std::string& name, size_t readers_count, TStorage&& storage) {
+        for (size_t i = 0; i < prefilled; ++i)
+            storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"});
+
+        std::vector<std::chrono::nanoseconds> latencies{};
+        std::atomic_bool                      done{};
+        {
+            // Readers hammer point reads and listing pages till producer is done
+            std::vector<std::jthread> readers{};
+            for (size_t r = 0; r < readers_count; ++r)
+            {
+                readers.emplace_back([&, r] {
+                    for (size_t i = r; !done.load(std::memory_order_relaxed); i += 7919)
+                    {
+                        ankerl::nanobench::doNotOptimizeAway(storage.GetTask(i % prefilled));
+                        ankerl::nanobench::doNotOptimizeAway(storage.GetTasks(i % prefilled, 100));
+                    }
+                });
+            }
+
+            bench.run(name + ", " + std::to_string(readers_count) + " readers", [&] {
+                for (size_t i = 0; i < creates; ++i)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    ankerl::nanobench::doNotOptimizeAway(storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"}));
+                    latencies.push_back(std::chrono::steady_clock::now() - start);
+                }
+            });
+            done = true;
+        }
+
+        std::ranges::sort(latencies);
+        const auto percentile = [&](double p) { return std::chrono::duration<double, std::micro>(latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))]).count(); };
+        std::cout << name << ", " << readers_count << " readers: p50 " << percentile(0.5) << "us, p99 " << percentile(0.99) << "us, p99.9 " << percentile(0.999) << "us\n";
+    };
+
+    ankerl::nanobench::Bench bench{};
+    bench.title("CreateTask under concurrent GetTask/GetTasks").unit("task").batch(creates).epochs(5).epochIterations(1);
+    for (const size_t readers_count : {0, 2, 4, 8})
+    {
+        bench_mixed(bench, "InMemoryStorage", readers_count, backend::data_storage::InMemoryStorage{});
+        bench_mixed(bench, "ShardedStorage", readers_count, backend::data_storage::ShardedStorage{});
+    }
+}
+
+TEST_CASE("DeleteTask from front by queue size")
+{
+    constexpr size_t deletes = 1'000;
+
+    const auto bench_delete = []<typename TStorage>(ankerl::nanobench::Bench& bench, const std::string& name, size_t queue_size, TStorage&& storage) {
+        for (size_t i = 0; i < queue_size; ++i)
+            storage.CreateTask(backend::TaskPayload{.name = "name", .description = "description"});
+
+        size_t front = 0;
+        bench.run(name + ", " + std::to_string(queue_size) + " tasks", [&] {
+            for (size_t i = 0; i < deletes; ++i)
+                storage.DeleteTask(front++);
+        });
+    };
+
+    ankerl::nanobench::Bench bench{};
+    bench.title("DeleteTask from front").unit("task").batch(deletes).epochs(5).epochIterations(1);
+    for (const size_t queue_size : {10'000, 100'000, 1'000'000})
+    {
+        bench_delete(bench, "InMemoryStorage", queue_size, backend::data_storage::InMemoryStorage{});
+        bench_delete(bench, "ShardedStorage", queue_size, backend::data_storage::ShardedStorage{});
+    }
+}
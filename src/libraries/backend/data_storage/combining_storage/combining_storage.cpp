@@ -0,0 +1,247 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "combining_storage.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace backend::data_storage
+{
+    namespace
+    {
+        size_t FirstSlot()
+        {
+            thread_local const size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % CombiningStorage::slots_count;
+            return slot;
+        }
+    } // namespace
+
+    CombiningStorage::CombiningStorage(std::unique_ptr<DataStorage> storage)
+        : m_storage{std::move(storage)}
+    {
+        if (!m_storage)
+            throw std::invalid_argument("Storage cannot be null");
+
+        m_batch.reserve(slots_count);
+        m_payloads.reserve(slots_count);
+    }
+
+    CombiningStorage::~CombiningStorage() = default;
+
+    Task CombiningStorage::CreateTask(const TaskPayload& payload)
+    {
+        auto& slot   = ClaimSlot();
+        slot.payload = payload;
+        slot.state.store(Slot::State::Pending);
+
+        // Either some combiner applies the payload, or this caller becomes the combiner itself.
+        // Caller sleeps while another combiner is busy, that one either applies the payload or hands combining over to the caller
+        while (true)
+        {
+            const auto state = slot.state.load(std::memory_order_acquire);
+            if (state == Slot::State::Done)
+                break;
+
+            if (state == Slot::State::HandedOver)
+                m_combiner.lock();
+            else if (!m_combiner.try_lock())
+            {
+                slot.state.wait(Slot::State::Pending, std::memory_order_acquire);
+                continue;
+            }
+
+            Combine();
+            m_combiner.unlock();
+            HandOver();
+        }
+
+        auto result = std::move(slot.result);
+        auto error  = std::exchange(slot.error, nullptr);
+        slot.result.reset();
+        slot.state.store(Slot::State::Free, std::memory_order_release);
+
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(result).value();
+    }
+
+    void CombiningStorage::DeleteTask(size_t index)
+    {
+        m_storage->DeleteTask(index);
+    }
+
+    std::optional<Task> CombiningStorage::GetTask(size_t index) const
+    {
+        return m_storage->GetTask(index);
+    }
+
+    std::vector<Task> CombiningStorage::GetTasks() const
+    {
+        return m_storage->GetTasks();
+    }
+
+    std::vector<Task> CombiningStorage::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        return m_storage->GetTasks(after, limit);
+    }
+
+    std::vector<Task> CombiningStorage::CreateTasks(std::span<const TaskPayload> payloads)
+    {
+        return m_storage->CreateTasks(payloads);
+    }
+
+    std::vector<Task> CombiningStorage::GetTasks(std::span<const size_t> ids) const
+    {
+        return m_storage->GetTasks(ids);
+    }
+
+    void CombiningStorage::DeleteTasks(std::span<const size_t> ids)
+    {
+        m_storage->DeleteTasks(ids);
+    }
+
+    std::vector<Task> CombiningStorage::Dequeue(size_t count)
+    {
+        return m_storage->Dequeue(count);
+    }
+
+    std::vector<Task> CombiningStorage::Claim(size_t count, Clock::time_point deadline)
+    {
+        return m_storage->Claim(count, deadline);
+    }
+
+    bool CombiningStorage::Ack(size_t index)
+    {
+        return m_storage->Ack(index);
+    }
+
+    bool CombiningStorage::Nack(size_t index)
+    {
+        return m_storage->Nack(index);
+    }
+
+    FailResult CombiningStorage::Fail(size_t index, const RetryPolicy& policy, Clock::time_point now)
+    {
+        return m_storage->Fail(index, policy, now);
+    }
+
+    std::vector<Task> CombiningStorage::GetDeadLetters() const
+    {
+        return m_storage->GetDeadLetters();
+    }
+
+    bool CombiningStorage::Redrive(size_t index)
+    {
+        return m_storage->Redrive(index);
+    }
+
+    bool CombiningStorage::ExtendLease(size_t index, Clock::time_point deadline)
+    {
+        return m_storage->ExtendLease(index, deadline);
+    }
+
+    size_t CombiningStorage::ExpireLeases(Clock::time_point now)
+    {
+        return m_storage->ExpireLeases(now);
+    }
+
+    size_t CombiningStorage::PromoteDelayed(Clock::time_point now)
+    {
+        return m_storage->PromoteDelayed(now);
+    }
+
+    void CombiningStorage::Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id)
+    {
+        m_storage->Restore(std::move(tasks), std::move(dead_letters), next_id);
+    }
+
+    CombiningStorage::Slot& CombiningStorage::ClaimSlot()
+    {
+        // Every thread starts from its own slot, so slots are shared only when there are more threads than slots
+        for (size_t probe = 0;; ++probe)
+        {
+            auto& slot     = m_slots[(FirstSlot() + probe) % slots_count];
+            auto  expected = Slot::State::Free;
+            if (slot.state.compare_exchange_strong(expected, Slot::State::Claimed, std::memory_order_acquire, std::memory_order_relaxed))
+                return slot;
+
+            if ((probe + 1) % slots_count == 0)
+                std::this_thread::yield();
+        }
+    }
+
+    void CombiningStorage::Combine()
+    {
+        m_batch.clear();
+        m_payloads.clear();
+        for (auto& slot : m_slots)
+        {
+            const auto state = slot.state.load(std::memory_order_acquire);
+            if (state != Slot::State::Pending && state != Slot::State::HandedOver)
+                continue;
+
+            m_batch.push_back(&slot);
+            m_payloads.push_back(std::move(slot.payload));
+        }
+        if (m_batch.empty())
+            return;
+
+        std::vector<Task>  tasks{};
+        std::exception_ptr error{};
+        try
+        {
+            tasks = m_storage->CreateTasks(m_payloads);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        // Storage creates a prefix of the batch when the queue gets full, callers of the rest get the same error as CreateTask gives.
+        // Failed batch could be partially applied already, so it isn't retried: every caller of it gets the error
+        for (size_t i = 0; i < m_batch.size(); ++i)
+        {
+            auto& slot = *m_batch[i];
+            if (error)
+                slot.error = error;
+            else if (i < tasks.size())
+                slot.result = std::move(tasks[i]);
+            else
+                slot.error = std::make_exception_ptr(std::length_error("Queue is full"));
+            slot.state.store(Slot::State::Done, std::memory_order_release);
+            slot.state.notify_one();
+        }
+    }
+
+    void CombiningStorage::HandOver()
+    {
+        // Payload published after the last scan of the combiner isn't applied by it, and its caller could fail to become the combiner while
+        // the lock was still held, so the caller is woken to combine
+        for (auto& slot : m_slots)
+        {
+            auto expected = Slot::State::Pending;
+            if (slot.state.compare_exchange_strong(expected, Slot::State::HandedOver))
+            {
+                slot.state.notify_one();
+                return;
+            }
+        }
+    }
+} // namespace backend::data_storage
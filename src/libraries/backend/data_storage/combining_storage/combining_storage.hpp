@@ -0,0 +1,96 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/data_storage/interface/data_storage.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Flat-combining front-end: concurrent CreateTask calls are applied to the underlying storage as one CreateTasks batch.
+     * @details Caller publishes its payload into a slot, and whoever grabs the combiner lock applies every published payload at once and hands back the tasks.
+     * So under contention the underlying storage lock is taken once per batch instead of once per task, and its cache line stays on the combiner's core.
+     * Callers waiting for the combiner sleep on their slots instead of spinning. Other calls are forwarded as is.
+     */
+    class CombiningStorage final : public DataStorage
+    {
+    public:
+        static constexpr size_t slots_count = 64;
+
+        explicit CombiningStorage(std::unique_ptr<DataStorage> storage);
+        ~CombiningStorage() override;
+
+        Task                CreateTask(const TaskPayload& payload) override;
+        void                DeleteTask(size_t index) override;
+        std::optional<Task> GetTask(size_t index) const override;
+        std::vector<Task>   GetTasks() const override;
+        std::vector<Task>   GetTasks(std::optional<size_t> after, size_t limit) const override;
+        std::vector<Task>   CreateTasks(std::span<const TaskPayload> payloads) override;
+        std::vector<Task>   GetTasks(std::span<const size_t> ids) const override;
+        void                DeleteTasks(std::span<const size_t> ids) override;
+        std::vector<Task>   Dequeue(size_t count) override;
+        std::vector<Task>   Claim(size_t count, Clock::time_point deadline) override;
+        bool                Ack(size_t index) override;
+        bool                Nack(size_t index) override;
+        FailResult          Fail(size_t index, const RetryPolicy& policy, Clock::time_point now) override;
+        std::vector<Task>   GetDeadLetters() const override;
+        bool                Redrive(size_t index) override;
+        bool                ExtendLease(size_t index, Clock::time_point deadline) override;
+        size_t              ExpireLeases(Clock::time_point now) override;
+        size_t              PromoteDelayed(Clock::time_point now) override;
+        void                Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id) override;
+
+    private:
+        struct alignas(64) Slot
+        {
+            enum class State : uint8_t
+            {
+                Free,
+                Claimed,
+                Pending,
+                HandedOver, // Pending, and its caller is the next combiner
+                Done,
+            };
+
+            std::atomic<State>  state{State::Free};
+            TaskPayload         payload{};
+            std::optional<Task> result{};
+            std::exception_ptr  error{};
+        };
+
+        Slot& ClaimSlot();
+        void  Combine();
+        void  HandOver();
+
+    private:
+        std::unique_ptr<DataStorage>  m_storage;
+        std::array<Slot, slots_count> m_slots{};
+        std::mutex                    m_combiner{};
+        std::vector<Slot*>            m_batch{};    // Guarded by m_combiner, kept to reuse allocations
+        std::vector<TaskPayload>      m_payloads{}; // Guarded by m_combiner, kept to reuse allocations
+    };
+} // namespace backend::data_storage
@@ -0,0 +1,119 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <doctest/trompeloeil.hpp>
+
+#include <libraries/backend/data_storage/combining_storage/combining_storage.hpp>
+#include <libraries/backend/data_storage/interface/data_storage_mock.hpp>
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("CombiningStorage hands every caller its own task")
+{
+    constexpr size_t threads_count    = 16;
+    constexpr size_t tasks_per_thread = 500;
+
+    backend::data_storage::CombiningStorage storage{std::make_unique<backend::data_storage::InMemoryStorage>()};
+
+    std::vector<std::vector<backend::Task>> created(threads_count);
+    {
+        std::vector<std::jthread> threads{};
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&storage, &result = created[i], i] {
+                for (size_t j = 0; j < tasks_per_thread; ++j)
+                    result.push_back(storage.CreateTask(backend::TaskPayload{.name = std::to_string(i), .description = std::to_string(j)}));
+            });
+        }
+    }
+
+    std::set<size_t> ids{};
+    for (size_t i = 0; i < threads_count; ++i)
+    {
+        REQUIRE(created[i].size() == tasks_per_thread);
+        for (size_t j = 0; j < tasks_per_thread; ++j)
+        {
+            const auto& task = created[i][j];
+            REQUIRE(task.payload == backend::TaskPayload{.name = std::to_string(i), .description = std::to_string(j)});
+            REQUIRE(storage.GetTask(task.id) == task);
+            REQUIRE(ids.insert(task.id).second);
+
+            // Calls of one thread are applied in order
+            if (j != 0)
+                REQUIRE(created[i][j - 1].id < task.id);
+        }
+    }
+    REQUIRE(storage.GetTasks().size() == threads_count * tasks_per_thread);
+}
+
+TEST_CASE("CombiningStorage rejects callers above queue capacity")
+{
+    constexpr size_t threads_count    = 8;
+    constexpr size_t tasks_per_thread = 5;
+    constexpr size_t queue_capacity   = 16;
+
+    backend::data_storage::CombiningStorage storage{std::make_unique<backend::data_storage::InMemoryStorage>(queue_capacity)};
+
+    std::atomic_size_t created{};
+    std::atomic_size_t rejected{};
+    {
+        std::vector<std::jthread> threads{};
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&] {
+                for (size_t j = 0; j < tasks_per_thread; ++j)
+                {
+                    try
+                    {
+                        storage.CreateTask(backend::TaskPayload{});
+                        ++created;
+                    }
+                    catch (const std::length_error&)
+                    {
+                        ++rejected;
+                    }
+                }
+            });
+        }
+    }
+
+    REQUIRE(created == queue_capacity);
+    REQUIRE(rejected == threads_count * tasks_per_thread - queue_capacity);
+    REQUIRE(storage.GetTasks().size() == queue_capacity);
+}
+
+TEST_CASE("CombiningStorage doesn't retry failed batch")
+{
+    auto  mock         = std::make_unique<MockDataStorage>();
+    auto& storage_mock = *mock;
+
+    backend::data_storage::CombiningStorage storage{std::move(mock)};
+
+    const backend::Task task{.id = 1, .payload = {.name = "name"}};
+    REQUIRE_CALL(storage_mock, CreateTasks(trompeloeil::_)).THROW(std::runtime_error{"batch failed"});
+    FORBID_CALL(storage_mock, CreateTask(trompeloeil::_));
+
+    REQUIRE_THROWS_AS(storage.CreateTask(task.payload), std::runtime_error);
+}
@@ -0,0 +1,67 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "delays.hpp"
+
+namespace backend::data_storage
+{
+    Delays::Delays(Clock::time_point now)
+        : m_wheel{ToUnixMilliseconds(now)}
+    {
+    }
+
+    bool Delays::Delay(size_t id, const TaskPayload& payload, Clock::time_point now)
+    {
+        return Schedule(id, payload.run_at, now);
+    }
+
+    bool Delays::Delay(size_t id, Clock::time_point run_at, Clock::time_point now)
+    {
+        return Schedule(id, ToUnixMilliseconds(run_at), now);
+    }
+
+    void Delays::Retry(size_t id)
+    {
+        m_wheel.Schedule(m_wheel.Now() + 1, id);
+        m_ids.insert(id);
+    }
+
+    bool Delays::Cancel(size_t id)
+    {
+        return m_ids.erase(id) != 0;
+    }
+
+    bool Delays::Schedule(size_t id, uint64_t run_at, Clock::time_point now)
+    {
+        if (run_at <= ToUnixMilliseconds(now))
+            return false;
+
+        m_wheel.Schedule(run_at, id);
+        m_ids.insert(id);
+        return true;
+    }
+
+    std::vector<size_t> Delays::Due(Clock::time_point now)
+    {
+        std::vector<size_t> result{};
+        m_wheel.Advance(ToUnixMilliseconds(now), [this, &result](size_t&& id) {
+            if (m_ids.erase(id) != 0)
+                result.push_back(id);
+        });
+        return result;
+    }
+} // namespace backend::data_storage
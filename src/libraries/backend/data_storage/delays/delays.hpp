@@ -0,0 +1,69 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/interface/task/task.hpp>
+#include <libraries/utils/timing_wheel.hpp>
+
+#include <unordered_set>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Not thread-safe registry of delayed task ids waiting for their run time.
+     * @details Run times are tracked by a hierarchical timing wheel with millisecond ticks, so promotion touches due ids only and never scans all delayed tasks.
+     * Cancelled ids stay in the wheel till they are due and are skipped then, so cancellation is O(1) too.
+     */
+    class Delays
+    {
+    public:
+        explicit Delays(Clock::time_point now = Clock::now());
+
+        /**
+         * @brief Holds task back if its run time is after `now`
+         * @return false if task is ready at once and has to be queued by the caller
+         */
+        bool Delay(size_t id, const TaskPayload& payload, Clock::time_point now);
+        bool Delay(size_t id, Clock::time_point run_at, Clock::time_point now);
+
+        /**
+         * @brief Hands id out again on the next tick, e.g. when it can't be queued right now
+         */
+        void Retry(size_t id);
+
+        /**
+         * @return false if id is not delayed
+         */
+        bool Cancel(size_t id);
+
+        /**
+         * @return ids with run time <= now, they are removed from the registry
+         */
+        std::vector<size_t> Due(Clock::time_point now);
+
+        size_t Size() const { return m_ids.size(); }
+
+    private:
+        bool Schedule(size_t id, uint64_t run_at, Clock::time_point now);
+
+    private:
+        utils::TimingWheel<size_t> m_wheel;
+        std::unordered_set<size_t> m_ids{};
+    };
+} // namespace backend::data_storage
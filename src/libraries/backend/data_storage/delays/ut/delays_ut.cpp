@@ -0,0 +1,89 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/data_storage/delays/delays.hpp>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    backend::TaskPayload RunAt(backend::Clock::time_point time)
+    {
+        return backend::TaskPayload{.run_at = backend::ToUnixMilliseconds(time)};
+    }
+} // namespace
+
+TEST_CASE("Delays hold tasks back till their run time")
+{
+    const auto                    start = backend::Clock::time_point{} + 1'000'000h;
+    backend::data_storage::Delays delays{start};
+
+    SUBCASE("ready tasks are not delayed")
+    {
+        REQUIRE(!delays.Delay(1, backend::TaskPayload{}, start));
+        REQUIRE(!delays.Delay(2, RunAt(start), start));
+        REQUIRE(!delays.Delay(3, RunAt(start - 1h), start));
+        REQUIRE(delays.Size() == 0);
+    }
+
+    SUBCASE("due in run time order")
+    {
+        REQUIRE(delays.Delay(1, RunAt(start + 20ms), start));
+        REQUIRE(delays.Delay(2, RunAt(start + 10ms), start));
+        REQUIRE(delays.Delay(3, RunAt(start + 24h), start));
+        REQUIRE(delays.Size() == 3);
+
+        REQUIRE(delays.Due(start + 9ms).empty());
+        REQUIRE(delays.Due(start + 10ms) == std::vector<size_t>{2});
+        REQUIRE(delays.Due(start + 19ms).empty());
+        REQUIRE(delays.Due(start + 1h) == std::vector<size_t>{1});
+        REQUIRE(delays.Due(start + 24h) == std::vector<size_t>{3});
+        REQUIRE(delays.Size() == 0);
+    }
+
+    SUBCASE("delay till time point")
+    {
+        REQUIRE(!delays.Delay(1, start, start));
+        REQUIRE(delays.Delay(2, start + 1s, start));
+        REQUIRE(delays.Due(start + 999ms).empty());
+        REQUIRE(delays.Due(start + 1s) == std::vector<size_t>{2});
+    }
+
+    SUBCASE("retried id is due on the next tick")
+    {
+        REQUIRE(delays.Delay(1, RunAt(start + 10ms), start));
+        REQUIRE(delays.Due(start + 10ms) == std::vector<size_t>{1});
+
+        delays.Retry(1);
+        REQUIRE(delays.Due(start + 10ms).empty());
+        REQUIRE(delays.Due(start + 11ms) == std::vector<size_t>{1});
+    }
+
+    SUBCASE("cancelled id is never due")
+    {
+        REQUIRE(delays.Delay(1, RunAt(start + 10ms), start));
+        REQUIRE(delays.Delay(2, RunAt(start + 10ms), start));
+        REQUIRE(delays.Cancel(1));
+        REQUIRE(!delays.Cancel(1));
+        REQUIRE(!delays.Cancel(3));
+        REQUIRE(delays.Size() == 1);
+        REQUIRE(delays.Due(start + 10ms) == std::vector<size_t>{2});
+        REQUIRE(!delays.Cancel(2));
+    }
+}
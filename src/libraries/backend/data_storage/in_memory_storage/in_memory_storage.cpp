@@ -17,44 +17,278 @@
 
 #include "in_memory_storage.hpp"
 
-#include <algorithm>
+#include <mutex>
+#include <stdexcept>
 
 namespace backend::data_storage
 {
-    InMemoryStorage::InMemoryStorage()  = default;
+    InMemoryStorage::InMemoryStorage(size_t queue_capacity)
+        : m_queue{queue_capacity}
+    {
+    }
+
     InMemoryStorage::~InMemoryStorage() = default;
 
     Task InMemoryStorage::CreateTask(const TaskPayload& payload)
     {
+        const auto      now = Clock::now();
         std::lock_guard _{m_mutex};
-        m_tasks.emplace_back(Task{.id = m_id++, .payload = payload});
-        return m_tasks.back();
+        if (!m_delays.Delay(m_id, payload, now) && !m_queue.TryPush(m_id, payload.priority))
+            throw std::length_error("Queue is full");
+
+        Task task{.id = m_id++, .payload = payload};
+        m_tasks.Insert(task);
+        return task;
     }
 
     void InMemoryStorage::DeleteTask(size_t index)
     {
         std::lock_guard _{m_mutex};
-        const auto      itr = std::ranges::lower_bound(m_tasks, index, std::ranges::less{}, &Task::id);
-        if (itr == m_tasks.end() || itr->id != index)
-            return;
-
-        m_tasks.erase(itr);
+        Erase(index);
     }
 
     std::optional<Task> InMemoryStorage::GetTask(size_t index) const
     {
+        return m_tasks.Get(index);
+    }
+
+    std::vector<Task> InMemoryStorage::GetTasks() const
+    {
+        return m_tasks.GetTasks();
+    }
+
+    std::vector<Task> InMemoryStorage::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        return m_tasks.GetTasks(after, limit);
+    }
+
+    std::vector<Task> InMemoryStorage::CreateTasks(std::span<const TaskPayload> payloads)
+    {
+        std::vector<Task> result{};
+        result.reserve(payloads.size());
+
+        const auto      now = Clock::now();
         std::lock_guard _{m_mutex};
-        const auto      itr = std::ranges::lower_bound(m_tasks, index, std::ranges::less{}, &Task::id);
-        if (itr == m_tasks.end() || itr->id != index)
-            return {};
+        for (const auto& payload : payloads)
+        {
+            if (!m_delays.Delay(m_id, payload, now) && !m_queue.TryPush(m_id, payload.priority))
+                break;
 
-        return *itr;
+            m_tasks.Insert(result.emplace_back(Task{.id = m_id++, .payload = payload}));
+        }
+        return result;
     }
 
-    std::vector<Task> InMemoryStorage::GetTasks() const
+    std::vector<Task> InMemoryStorage::GetTasks(std::span<const size_t> ids) const
+    {
+        return m_tasks.Get(ids);
+    }
+
+    void InMemoryStorage::DeleteTasks(std::span<const size_t> ids)
+    {
+        std::lock_guard _{m_mutex};
+        for (const auto id : ids)
+            Erase(id);
+    }
+
+    std::vector<Task> InMemoryStorage::Dequeue(size_t count)
+    {
+        std::vector<Task> result{};
+        std::lock_guard   _{m_mutex};
+        while (result.size() < count)
+        {
+            const auto id = m_queue.TryPop();
+            if (!id)
+                break;
+
+            // Task could be deleted already, its id is skipped then
+            if (auto task = m_tasks.Extract(id.value()))
+                result.push_back(std::move(task).value());
+            else
+                m_queue.DropStale();
+        }
+        return result;
+    }
+
+    std::vector<Task> InMemoryStorage::Claim(size_t count, Clock::time_point deadline)
+    {
+        std::vector<Task> result{};
+        std::lock_guard   _{m_mutex};
+        while (result.size() < count)
+        {
+            const auto id = m_queue.TryPop();
+            if (!id)
+                break;
+
+            // Task could be deleted already, its id is skipped then
+            if (auto task = m_tasks.Get(id.value()))
+            {
+                m_leases.Acquire(id.value(), deadline);
+                result.push_back(std::move(task).value());
+            }
+            else
+                m_queue.DropStale();
+        }
+        return result;
+    }
+
+    bool InMemoryStorage::Ack(size_t index)
     {
-        std::shared_lock _{m_mutex};
-        return m_tasks;
+        std::lock_guard _{m_mutex};
+        if (!m_leases.Release(index))
+            return false;
+
+        m_tasks.Erase(index);
+        return true;
     }
 
+    bool InMemoryStorage::Nack(size_t index)
+    {
+        std::lock_guard _{m_mutex};
+        if (!m_leases.Release(index))
+            return false;
+
+        Requeue(index);
+        return true;
+    }
+
+    FailResult InMemoryStorage::Fail(size_t index, const RetryPolicy& policy, Clock::time_point now)
+    {
+        std::lock_guard _{m_mutex};
+        if (!m_leases.Release(index))
+            return FailResult::NotLeased;
+
+        // Leased task can't be deleted without releasing its lease
+        auto task = m_tasks.Get(index).value();
+        ++task.attempts;
+        m_tasks.Insert(task);
+
+        if (policy.IsExhausted(task.attempts))
+        {
+            m_dead_letters.insert(index);
+            return FailResult::DeadLettered;
+        }
+
+        // Queue is full: task is retried on the next promotion
+        if (!m_delays.Delay(index, now + policy.Backoff(task.attempts), now) && !m_queue.TryPush(index, task.payload.priority))
+            m_delays.Retry(index);
+        return FailResult::Retried;
+    }
+
+    std::vector<Task> InMemoryStorage::GetDeadLetters() const
+    {
+        std::vector<size_t> ids{};
+        {
+            std::lock_guard _{m_mutex};
+            ids.assign(m_dead_letters.begin(), m_dead_letters.end());
+        }
+        return m_tasks.Get(ids);
+    }
+
+    bool InMemoryStorage::Redrive(size_t index)
+    {
+        std::lock_guard _{m_mutex};
+        if (!m_dead_letters.erase(index))
+            return false;
+
+        auto task     = m_tasks.Get(index).value();
+        task.attempts = 0;
+        m_tasks.Insert(task);
+
+        // Queue is full: task is retried on the next promotion
+        if (!m_queue.TryPush(index, task.payload.priority))
+            m_delays.Retry(index);
+        return true;
+    }
+
+    bool InMemoryStorage::ExtendLease(size_t index, Clock::time_point deadline)
+    {
+        std::lock_guard _{m_mutex};
+        return m_leases.Extend(index, deadline);
+    }
+
+    size_t InMemoryStorage::ExpireLeases(Clock::time_point now)
+    {
+        std::lock_guard _{m_mutex};
+
+        size_t count = 0;
+        for (const auto id : m_leases.Expire(now))
+        {
+            if (Requeue(id))
+                ++count;
+        }
+        return count;
+    }
+
+    size_t InMemoryStorage::PromoteDelayed(Clock::time_point now)
+    {
+        std::lock_guard _{m_mutex};
+
+        size_t count = 0;
+        for (const auto id : m_delays.Due(now))
+        {
+            // Task could be deleted already, its id is skipped then
+            const auto priority = m_tasks.GetPriority(id);
+            if (!priority)
+                continue;
+
+            // Queue is full: task stays delayed and is retried on the next promotion
+            if (!m_queue.TryPush(id, priority.value()))
+                m_delays.Retry(id);
+            else
+                ++count;
+        }
+        return count;
+    }
+
+    void InMemoryStorage::Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id)
+    {
+        const auto      now = Clock::now();
+        std::lock_guard _{m_mutex};
+        if (m_id != 0)
+            throw std::logic_error("Only empty storage can be restored");
+
+        // Recovered tasks could exceed the queue capacity, e.g. after it was lowered: overflow is retried on the next promotion
+        for (auto& task : tasks)
+        {
+            if (!m_delays.Delay(task.id, task.payload, now) && !m_queue.TryPush(task.id, task.payload.priority))
+                m_delays.Retry(task.id);
+            m_tasks.Insert(task);
+        }
+        for (auto& task : dead_letters)
+        {
+            m_dead_letters.insert(task.id);
+            m_tasks.Insert(task);
+        }
+        m_id = next_id;
+    }
+
+    bool InMemoryStorage::Requeue(size_t index)
+    {
+        const auto priority = m_tasks.GetPriority(index);
+        if (!priority)
+            return false;
+
+        if (m_queue.TryPush(index, priority.value()))
+            return true;
+
+        // Queue is full: task stays leased and is retried on the next expiration
+        m_leases.Acquire(index, Clock::time_point{});
+        return false;
+    }
+
+    void InMemoryStorage::Erase(size_t index)
+    {
+        if (!m_tasks.Erase(index))
+            return;
+
+        // Task is either leased, dead, delayed or queued. Queued id can't be taken out of the middle of the queue,
+        // so it is marked stale to free its place at once and is dropped when popped or erased together with other stale ids
+        if (m_leases.Release(index) || m_dead_letters.erase(index) != 0 || m_delays.Cancel(index))
+            return;
+
+        m_queue.MarkStale();
+        if (m_queue.HasManyStale())
+            m_queue.EraseStale([this](size_t id) { return !m_tasks.Contains(id); });
+    }
 } // namespace backend::data_storage
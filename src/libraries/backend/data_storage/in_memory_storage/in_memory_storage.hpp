@@ -17,26 +17,65 @@
 
 #pragma once
 
+#include <libraries/backend/data_storage/delays/delays.hpp>
 #include <libraries/backend/data_storage/interface/data_storage.hpp>
+#include <libraries/backend/data_storage/leases/leases.hpp>
+#include <libraries/backend/data_storage/task_table/concurrent_task_table.hpp>
+#include <libraries/utils/bucket_queue.hpp>
 
-#include <shared_mutex>
+#include <mutex>
+#include <set>
 
 namespace backend::data_storage
 {
+    /**
+     * @brief In-memory storage with writers and consumers serialized by a single mutex.
+     * @details Reads (GetTask/GetTasks) never take the mutex: they go through RCU snapshots of the task table, so readers and writers never stall each other.
+     * Queued ids are bucketed by priority, so dequeue order is the highest priority first and creation order within a priority.
+     * Delayed tasks and failed tasks waiting for their backoff are not queued (and don't count against the queue capacity) till PromoteDelayed reaches their run time.
+     */
     class InMemoryStorage final : public DataStorage
     {
     public:
-        InMemoryStorage();
+        static constexpr size_t default_queue_capacity = size_t{1} << 20;
+
+        /**
+         * @param queue_capacity max count of tasks waiting for dequeue, CreateTask throws when it is reached
+         */
+        explicit InMemoryStorage(size_t queue_capacity = default_queue_capacity);
         ~InMemoryStorage() override;
 
         Task                CreateTask(const TaskPayload& payload) override;
         void                DeleteTask(size_t index) override;
         std::optional<Task> GetTask(size_t index) const override;
         std::vector<Task>   GetTasks() const override;
+        std::vector<Task>   GetTasks(std::optional<size_t> after, size_t limit) const override;
+        std::vector<Task>   CreateTasks(std::span<const TaskPayload> payloads) override;
+        std::vector<Task>   GetTasks(std::span<const size_t> ids) const override;
+        void                DeleteTasks(std::span<const size_t> ids) override;
+        std::vector<Task>   Dequeue(size_t count) override;
+        std::vector<Task>   Claim(size_t count, Clock::time_point deadline) override;
+        bool                Ack(size_t index) override;
+        bool                Nack(size_t index) override;
+        FailResult          Fail(size_t index, const RetryPolicy& policy, Clock::time_point now) override;
+        std::vector<Task>   GetDeadLetters() const override;
+        bool                Redrive(size_t index) override;
+        bool                ExtendLease(size_t index, Clock::time_point deadline) override;
+        size_t              ExpireLeases(Clock::time_point now) override;
+        size_t              PromoteDelayed(Clock::time_point now) override;
+        void                Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id) override;
+
+    private:
+        bool Requeue(size_t index);
+        void Erase(size_t index);
 
     private:
-        mutable std::shared_mutex m_mutex{};
-        std::vector<Task>         m_tasks{};
-        size_t                    m_id{};
+        mutable std::mutex         m_mutex{};
+        ConcurrentTaskTable        m_tasks{};
+        size_t                     m_id{};
+        utils::BucketQueue<size_t> m_queue;
+        Leases                     m_leases{};
+        Delays                     m_delays{};
+        std::set<size_t>           m_dead_letters{};
     };
 } // namespace backend::data_storage
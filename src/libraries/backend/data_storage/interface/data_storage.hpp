@@ -20,6 +20,7 @@
 #include <libraries/backend/interface/task/task.hpp>
 
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace backend
@@ -32,5 +33,90 @@ namespace backend
         virtual std::optional<Task> GetTask(size_t index) const            = 0;
         virtual void                DeleteTask(size_t index)               = 0;
         virtual std::vector<Task>   GetTasks() const                       = 0;
+
+        /**
+         * @brief Returns up to `limit` tasks with id greater than `after` (from the beginning if `after` is empty) in id order
+         * @details Touches only the requested window, so it is cheap regardless of the storage size
+         */
+        virtual std::vector<Task> GetTasks(std::optional<size_t> after, size_t limit) const = 0;
+
+        /**
+         * @brief Creates tasks in the given order within one pass over the storage
+         * @return created tasks, fewer than requested if the queue gets full: the rest should be retried later
+         */
+        virtual std::vector<Task> CreateTasks(std::span<const TaskPayload> payloads) = 0;
+
+        /**
+         * @return existing tasks among requested ones in the order of `ids`, missing ids are skipped
+         */
+        virtual std::vector<Task> GetTasks(std::span<const size_t> ids) const = 0;
+
+        virtual void DeleteTasks(std::span<const size_t> ids) = 0;
+
+        /**
+         * @brief Atomically removes up to `count` tasks of the highest priority (oldest first within a priority) from the storage and returns them
+         * @details Every task is handed out to exactly one caller even under concurrent calls
+         */
+        virtual std::vector<Task> Dequeue(size_t count) = 0;
+
+        /**
+         * @brief Leases up to `count` tasks in dequeue order till `deadline`: tasks stay in the storage but are hidden from other consumers
+         * @details Task returns to the queue automatically unless it is acked before lease expiration
+         */
+        virtual std::vector<Task> Claim(size_t count, Clock::time_point deadline) = 0;
+
+        /**
+         * @brief Removes leased task from the storage
+         * @return false if task is not leased (e.g. lease is expired already)
+         */
+        virtual bool Ack(size_t index) = 0;
+
+        /**
+         * @brief Returns leased task to the queue immediately, behind queued tasks of the same priority
+         * @return false if task is not leased
+         */
+        virtual bool Nack(size_t index) = 0;
+
+        /**
+         * @brief Counts failed attempt of leased task: task returns to the queue after backoff of `policy` or is moved to dead letters once attempts are exhausted
+         * @details Task waiting for its backoff is not queued, so it costs no dequeue work till then
+         */
+        virtual FailResult Fail(size_t index, const RetryPolicy& policy, Clock::time_point now) = 0;
+
+        /**
+         * @return tasks moved to dead letters in id order, they stay in the storage till deleted or redriven
+         */
+        virtual std::vector<Task> GetDeadLetters() const = 0;
+
+        /**
+         * @brief Returns dead letter to the queue with attempts reset
+         * @return false if task is not a dead letter
+         */
+        virtual bool Redrive(size_t index) = 0;
+
+        /**
+         * @brief Moves deadline of the lease
+         * @return false if task is not leased
+         */
+        virtual bool ExtendLease(size_t index, Clock::time_point deadline) = 0;
+
+        /**
+         * @brief Returns tasks with lease deadline <= `now` to the queue
+         * @return count of returned tasks
+         */
+        virtual size_t ExpireLeases(Clock::time_point now) = 0;
+
+        /**
+         * @brief Queues delayed tasks with run time <= `now`
+         * @return count of queued tasks
+         */
+        virtual size_t PromoteDelayed(Clock::time_point now) = 0;
+
+        /**
+         * @brief Fills empty storage with tasks recovered after restart, tasks are queued in the given order. Tasks above queue capacity wait for it as delayed ones
+         * @param dead_letters tasks recovered as dead letters, they are not queued
+         * @param next_id id of the next created task, so ids are never reused across restarts
+         */
+        virtual void Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id) = 0;
     };
 } // namespace backend
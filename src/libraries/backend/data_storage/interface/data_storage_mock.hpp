@@ -27,5 +27,21 @@ struct MockDataStorage final : public trompeloeil::mock_interface<backend::DataS
     IMPLEMENT_MOCK1(CreateTask);
     IMPLEMENT_MOCK1(DeleteTask);
     IMPLEMENT_CONST_MOCK1(GetTask);
-    IMPLEMENT_CONST_MOCK0(GetTasks);
+    // GetTasks is overloaded, so signatures have to be spelled explicitly
+    MAKE_CONST_MOCK0(GetTasks, std::vector<backend::Task>(), override);
+    MAKE_CONST_MOCK2(GetTasks, std::vector<backend::Task>(std::optional<size_t>, size_t), override);
+    MAKE_CONST_MOCK1(GetTasks, std::vector<backend::Task>(std::span<const size_t>), override);
+    IMPLEMENT_MOCK1(CreateTasks);
+    IMPLEMENT_MOCK1(DeleteTasks);
+    IMPLEMENT_MOCK1(Dequeue);
+    IMPLEMENT_MOCK2(Claim);
+    IMPLEMENT_MOCK1(Ack);
+    IMPLEMENT_MOCK1(Nack);
+    IMPLEMENT_MOCK3(Fail);
+    IMPLEMENT_CONST_MOCK0(GetDeadLetters);
+    IMPLEMENT_MOCK1(Redrive);
+    IMPLEMENT_MOCK2(ExtendLease);
+    IMPLEMENT_MOCK1(ExpireLeases);
+    IMPLEMENT_MOCK1(PromoteDelayed);
+    IMPLEMENT_MOCK3(Restore);
 };
@@ -0,0 +1,85 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "leases.hpp"
+
+namespace backend::data_storage
+{
+    Leases::Leases(Clock::time_point now)
+        : m_wheel{ToUnixMilliseconds(now)}
+    {
+    }
+
+    void Leases::Acquire(size_t id, Clock::time_point deadline)
+    {
+        const auto generation = m_generation++;
+        m_leases.insert_or_assign(id, Lease{.deadline = deadline, .generation = generation});
+        Schedule(deadline, Entry{.id = id, .generation = generation});
+    }
+
+    bool Leases::Release(size_t id)
+    {
+        return m_leases.erase(id) != 0;
+    }
+
+    bool Leases::Extend(size_t id, Clock::time_point deadline)
+    {
+        const auto itr = m_leases.find(id);
+        if (itr == m_leases.end())
+            return false;
+
+        // Shorter deadline can't wait for the already scheduled entry, a new one replaces it
+        if (deadline < itr->second.deadline)
+        {
+            itr->second.generation = m_generation++;
+            Schedule(deadline, Entry{.id = id, .generation = itr->second.generation});
+        }
+        itr->second.deadline = deadline;
+        return true;
+    }
+
+    bool Leases::Contains(size_t id) const
+    {
+        return m_leases.contains(id);
+    }
+
+    std::vector<size_t> Leases::Expire(Clock::time_point now)
+    {
+        std::vector<size_t> result{};
+        m_wheel.Advance(ToUnixMilliseconds(now), [&](Entry&& entry) {
+            const auto itr = m_leases.find(entry.id);
+            if (itr == m_leases.end() || itr->second.generation != entry.generation)
+                return;
+
+            // Extended lease or deadline within the current tick
+            if (itr->second.deadline > now)
+            {
+                Schedule(itr->second.deadline, entry);
+                return;
+            }
+
+            m_leases.erase(itr);
+            result.push_back(entry.id);
+        });
+        return result;
+    }
+
+    void Leases::Schedule(Clock::time_point deadline, Entry entry)
+    {
+        m_wheel.Schedule(ToUnixMilliseconds(deadline), entry);
+    }
+} // namespace backend::data_storage
@@ -0,0 +1,71 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/interface/task/task.hpp>
+#include <libraries/utils/timing_wheel.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Not thread-safe registry of leased (claimed but not acked yet) task ids with their deadlines.
+     * @details Deadlines are tracked by a hierarchical timing wheel with millisecond ticks, so expiration never scans all leases.
+     * Released and extended leases are validated lazily once their stale wheel entries are reached.
+     */
+    class Leases
+    {
+    public:
+        explicit Leases(Clock::time_point now = Clock::now());
+
+        void Acquire(size_t id, Clock::time_point deadline);
+        bool Release(size_t id);
+        bool Extend(size_t id, Clock::time_point deadline);
+        bool Contains(size_t id) const;
+
+        /**
+         * @brief Releases every lease with deadline <= now
+         * @return ids of released leases
+         */
+        std::vector<size_t> Expire(Clock::time_point now);
+
+        size_t Size() const { return m_leases.size(); }
+
+    private:
+        struct Lease
+        {
+            Clock::time_point deadline;
+            uint64_t          generation;
+        };
+
+        struct Entry
+        {
+            size_t   id;
+            uint64_t generation;
+        };
+
+        void Schedule(Clock::time_point deadline, Entry entry);
+
+    private:
+        std::unordered_map<size_t, Lease> m_leases{};
+        utils::TimingWheel<Entry>         m_wheel;
+        uint64_t                          m_generation{};
+    };
+} // namespace backend::data_storage
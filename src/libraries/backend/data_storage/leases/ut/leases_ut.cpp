@@ -0,0 +1,102 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/data_storage/leases/leases.hpp>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Leases expire at deadline")
+{
+    const auto                    start = backend::Clock::time_point{} + 1'000'000h;
+    backend::data_storage::Leases leases{start};
+
+    leases.Acquire(1, start + 10ms);
+    leases.Acquire(2, start + 20ms);
+    REQUIRE(leases.Size() == 2);
+    REQUIRE(leases.Contains(1));
+
+    SUBCASE("expire in order")
+    {
+        REQUIRE(leases.Expire(start + 9ms).empty());
+        REQUIRE(leases.Expire(start + 10ms) == std::vector<size_t>{1});
+        REQUIRE(!leases.Contains(1));
+        REQUIRE(leases.Expire(start + 1h) == std::vector<size_t>{2});
+        REQUIRE(leases.Size() == 0);
+    }
+
+    SUBCASE("released lease never expires")
+    {
+        REQUIRE(leases.Release(1));
+        REQUIRE(!leases.Release(1));
+        REQUIRE(leases.Expire(start + 1h) == std::vector<size_t>{2});
+    }
+
+    SUBCASE("extended lease expires at new deadline")
+    {
+        REQUIRE(leases.Extend(1, start + 30ms));
+        REQUIRE(leases.Expire(start + 20ms) == std::vector<size_t>{2});
+        REQUIRE(leases.Expire(start + 29ms).empty());
+        REQUIRE(leases.Expire(start + 30ms) == std::vector<size_t>{1});
+    }
+
+    SUBCASE("shortened lease expires at new deadline")
+    {
+        REQUIRE(leases.Extend(2, start + 5ms));
+        REQUIRE(leases.Expire(start + 5ms) == std::vector<size_t>{2});
+        REQUIRE(leases.Expire(start + 1h) == std::vector<size_t>{1});
+    }
+
+    SUBCASE("reacquired lease uses latest deadline")
+    {
+        REQUIRE(leases.Release(1));
+        leases.Acquire(1, start + 40ms);
+        REQUIRE(leases.Expire(start + 39ms) == std::vector<size_t>{2});
+        REQUIRE(leases.Expire(start + 40ms) == std::vector<size_t>{1});
+    }
+
+    SUBCASE("unknown lease can't be extended")
+    {
+        REQUIRE(!leases.Extend(3, start + 1h));
+        REQUIRE(!leases.Contains(3));
+    }
+}
+
+TEST_CASE("Leases handle many outstanding deadlines")
+{
+    const auto                    start = backend::Clock::time_point{} + 1'000'000h;
+    backend::data_storage::Leases leases{start};
+
+    constexpr size_t count = 100'000;
+    for (size_t i = 0; i < count; ++i)
+        leases.Acquire(i, start + std::chrono::milliseconds{(i * 7919) % 3'600'000});
+
+    size_t expired = 0;
+    for (auto now = start; now <= start + 1h; now += 1min)
+    {
+        for (const auto id : leases.Expire(now))
+        {
+            REQUIRE(start + std::chrono::milliseconds{(id * 7919) % 3'600'000} <= now);
+            ++expired;
+        }
+    }
+    REQUIRE(expired == count);
+    REQUIRE(leases.Size() == 0);
+}
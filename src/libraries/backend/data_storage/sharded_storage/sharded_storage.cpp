@@ -0,0 +1,472 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "sharded_storage.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace backend::data_storage
+{
+    ShardedStorage::ShardedStorage(size_t shards_count, size_t queue_capacity)
+        : m_queue{queue_capacity}
+    {
+        if (shards_count == 0)
+            throw std::invalid_argument("Shards count must be positive");
+
+        for (size_t i = 0; i < shards_count; ++i)
+            m_shards.emplace_back(shards_count, i);
+    }
+
+    ShardedStorage::~ShardedStorage() = default;
+
+    Task ShardedStorage::CreateTask(const TaskPayload& payload)
+    {
+        const auto now = Clock::now();
+        const Task task{.id = m_id.fetch_add(1, std::memory_order_relaxed), .payload = payload};
+        auto&      shard = GetShard(task.id);
+
+        std::lock_guard _{shard.mutex};
+        // Consumers pop id first and take the shard lock later, so publishing id before insertion is safe
+        if (!shard.delays.Delay(task.id, task.payload, now) && !Push(task.id, task.payload.priority))
+            throw std::length_error("Queue is full");
+
+        shard.tasks.Insert(task);
+        return task;
+    }
+
+    void ShardedStorage::DeleteTask(size_t index)
+    {
+        auto& shard = GetShard(index);
+
+        bool erase_stale{};
+        {
+            std::lock_guard _{shard.mutex};
+            erase_stale = Erase(shard, index);
+        }
+        if (erase_stale)
+            EraseStale();
+    }
+
+    std::optional<Task> ShardedStorage::GetTask(size_t index) const
+    {
+        const auto& shard = GetShard(index);
+
+        std::shared_lock _{shard.mutex};
+        return shard.tasks.Get(index);
+    }
+
+    std::vector<Task> ShardedStorage::GetTasks() const
+    {
+        std::vector<Task> result{};
+        for (const auto& shard : m_shards)
+        {
+            std::shared_lock _{shard.mutex};
+            shard.tasks.ForEach([&result](Task task) { result.push_back(std::move(task)); });
+        }
+        std::ranges::sort(result, std::ranges::less{}, &Task::id);
+        return result;
+    }
+
+    std::vector<Task> ShardedStorage::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        if (limit == 0)
+            return {};
+
+        // Only ids are collected from every shard, so at most `limit` tasks are copied whatever the count of shards is
+        std::vector<size_t> ids{};
+        auto                bound = std::numeric_limits<size_t>::max();
+        for (const auto& shard : m_shards)
+        {
+            std::shared_lock _{shard.mutex};
+            auto             shard_ids = shard.tasks.GetIds(after, limit + 1);
+            if (shard_ids.size() > limit)
+            {
+                // Shard has more tasks, so merged ids are complete only up to the last id collected from it
+                shard_ids.pop_back();
+                bound = std::min(bound, shard_ids.back());
+            }
+            ids.insert(ids.end(), shard_ids.begin(), shard_ids.end());
+        }
+        std::ranges::sort(ids);
+
+        std::vector<Task> result{};
+        result.reserve(std::min(limit, ids.size()));
+        for (const auto id : ids)
+        {
+            if (result.size() == limit || id > bound)
+                break;
+
+            // Task could be deleted in between, next id takes its place then
+            if (auto task = GetTask(id))
+                result.push_back(std::move(task).value());
+        }
+        return result;
+    }
+
+    std::vector<Task> ShardedStorage::CreateTasks(std::span<const TaskPayload> payloads)
+    {
+        std::vector<Task> result{};
+        if (payloads.empty())
+            return result;
+
+        const auto now   = Clock::now();
+        const auto first = m_id.fetch_add(payloads.size(), std::memory_order_relaxed);
+
+        // Every touched shard is locked before any id is published, so consumers never pop id of a task not inserted yet.
+        // Shards are always locked in index order, so concurrent batches can't deadlock
+        std::vector<size_t> shard_indexes{};
+        for (size_t i = 0; i < std::min(payloads.size(), m_shards.size()); ++i)
+            shard_indexes.push_back((first + i) % m_shards.size());
+        std::ranges::sort(shard_indexes);
+
+        std::vector<std::unique_lock<std::shared_mutex>> locks{};
+        locks.reserve(shard_indexes.size());
+        for (const auto shard_index : shard_indexes)
+            locks.emplace_back(m_shards[shard_index].mutex);
+
+        result.reserve(payloads.size());
+
+        // Queue is locked once for the whole batch and, like everywhere, inside of shard locks
+        std::lock_guard queue_lock{m_queue_mutex};
+        for (size_t i = 0; i < payloads.size(); ++i)
+        {
+            const Task task{.id = first + i, .payload = payloads[i]};
+            auto&      shard = GetShard(task.id);
+            if (!shard.delays.Delay(task.id, task.payload, now) && !m_queue.TryPush(task.id, task.payload.priority))
+                break;
+
+            shard.tasks.Insert(task);
+            result.push_back(task);
+        }
+        return result;
+    }
+
+    std::vector<Task> ShardedStorage::GetTasks(std::span<const size_t> ids) const
+    {
+        std::vector<std::optional<Task>> found(ids.size());
+        const auto                       positions = GroupByShard(ids);
+        for (size_t shard_index = 0; shard_index < m_shards.size(); ++shard_index)
+        {
+            if (positions[shard_index].empty())
+                continue;
+
+            const auto&      shard = m_shards[shard_index];
+            std::shared_lock _{shard.mutex};
+            for (const auto position : positions[shard_index])
+            {
+                found[position] = shard.tasks.Get(ids[position]);
+            }
+        }
+
+        std::vector<Task> result{};
+        result.reserve(ids.size());
+        for (auto& task : found)
+        {
+            if (task)
+                result.push_back(std::move(task).value());
+        }
+        return result;
+    }
+
+    void ShardedStorage::DeleteTasks(std::span<const size_t> ids)
+    {
+        const auto positions   = GroupByShard(ids);
+        bool       erase_stale = false;
+        for (size_t shard_index = 0; shard_index < m_shards.size(); ++shard_index)
+        {
+            if (positions[shard_index].empty())
+                continue;
+
+            auto&           shard = m_shards[shard_index];
+            std::lock_guard _{shard.mutex};
+            for (const auto position : positions[shard_index])
+                erase_stale |= Erase(shard, ids[position]);
+        }
+        if (erase_stale)
+            EraseStale();
+    }
+
+    std::vector<Task> ShardedStorage::Dequeue(size_t count)
+    {
+        std::vector<Task> result{};
+        while (result.size() < count)
+        {
+            const auto id = Pop();
+            if (!id)
+                break;
+
+            // Task could be deleted already, its id is skipped then
+            auto&           shard = GetShard(id.value());
+            std::lock_guard _{shard.mutex};
+            if (auto task = shard.tasks.Extract(id.value()))
+                result.push_back(std::move(task).value());
+            else
+                DropStale();
+        }
+        return result;
+    }
+
+    std::vector<Task> ShardedStorage::Claim(size_t count, Clock::time_point deadline)
+    {
+        std::vector<Task> result{};
+        while (result.size() < count)
+        {
+            const auto id = Pop();
+            if (!id)
+                break;
+
+            // Task could be deleted already, its id is skipped then
+            auto&           shard = GetShard(id.value());
+            std::lock_guard _{shard.mutex};
+            if (auto task = shard.tasks.Get(id.value()))
+            {
+                shard.leases.Acquire(id.value(), deadline);
+                result.push_back(std::move(task).value());
+            }
+            else
+                DropStale();
+        }
+        return result;
+    }
+
+    bool ShardedStorage::Ack(size_t index)
+    {
+        auto& shard = GetShard(index);
+
+        std::lock_guard _{shard.mutex};
+        if (!shard.leases.Release(index))
+            return false;
+
+        shard.tasks.Erase(index);
+        return true;
+    }
+
+    bool ShardedStorage::Nack(size_t index)
+    {
+        auto& shard = GetShard(index);
+
+        std::lock_guard _{shard.mutex};
+        if (!shard.leases.Release(index))
+            return false;
+
+        Requeue(shard, index);
+        return true;
+    }
+
+    FailResult ShardedStorage::Fail(size_t index, const RetryPolicy& policy, Clock::time_point now)
+    {
+        auto& shard = GetShard(index);
+
+        std::lock_guard _{shard.mutex};
+        if (!shard.leases.Release(index))
+            return FailResult::NotLeased;
+
+        // Leased task can't be deleted without releasing its lease
+        auto task = shard.tasks.Get(index).value();
+        ++task.attempts;
+        shard.tasks.Insert(task);
+
+        if (policy.IsExhausted(task.attempts))
+        {
+            shard.dead_letters.insert(index);
+            return FailResult::DeadLettered;
+        }
+
+        // Queue is full: task is retried on the next promotion
+        if (!shard.delays.Delay(index, now + policy.Backoff(task.attempts), now) && !Push(index, task.payload.priority))
+            shard.delays.Retry(index);
+        return FailResult::Retried;
+    }
+
+    std::vector<Task> ShardedStorage::GetDeadLetters() const
+    {
+        std::vector<Task> result{};
+        for (const auto& shard : m_shards)
+        {
+            std::shared_lock _{shard.mutex};
+            for (const auto id : shard.dead_letters)
+                result.push_back(shard.tasks.Get(id).value());
+        }
+        std::ranges::sort(result, std::ranges::less{}, &Task::id);
+        return result;
+    }
+
+    bool ShardedStorage::Redrive(size_t index)
+    {
+        auto& shard = GetShard(index);
+
+        std::lock_guard _{shard.mutex};
+        if (!shard.dead_letters.erase(index))
+            return false;
+
+        auto task     = shard.tasks.Get(index).value();
+        task.attempts = 0;
+        shard.tasks.Insert(task);
+
+        // Queue is full: task is retried on the next promotion
+        if (!Push(index, task.payload.priority))
+            shard.delays.Retry(index);
+        return true;
+    }
+
+    bool ShardedStorage::ExtendLease(size_t index, Clock::time_point deadline)
+    {
+        auto& shard = GetShard(index);
+
+        std::lock_guard _{shard.mutex};
+        return shard.leases.Extend(index, deadline);
+    }
+
+    size_t ShardedStorage::ExpireLeases(Clock::time_point now)
+    {
+        size_t count = 0;
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard _{shard.mutex};
+            for (const auto id : shard.leases.Expire(now))
+            {
+                if (Requeue(shard, id))
+                    ++count;
+            }
+        }
+        return count;
+    }
+
+    size_t ShardedStorage::PromoteDelayed(Clock::time_point now)
+    {
+        size_t count = 0;
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard _{shard.mutex};
+            for (const auto id : shard.delays.Due(now))
+            {
+                // Task could be deleted already, its id is skipped then
+                const auto priority = shard.tasks.GetPriority(id);
+                if (!priority)
+                    continue;
+
+                // Queue is full: task stays delayed and is retried on the next promotion
+                if (!Push(id, priority.value()))
+                    shard.delays.Retry(id);
+                else
+                    ++count;
+            }
+        }
+        return count;
+    }
+
+    void ShardedStorage::Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id)
+    {
+        const auto now      = Clock::now();
+        size_t     expected = 0;
+        if (!m_id.compare_exchange_strong(expected, next_id))
+            throw std::logic_error("Only empty storage can be restored");
+
+        // Recovered tasks could exceed the queue capacity, e.g. after it was lowered: overflow is retried on the next promotion
+        for (auto& task : tasks)
+        {
+            auto&           shard = GetShard(task.id);
+            std::lock_guard _{shard.mutex};
+            if (!shard.delays.Delay(task.id, task.payload, now) && !Push(task.id, task.payload.priority))
+                shard.delays.Retry(task.id);
+            shard.tasks.Insert(task);
+        }
+        for (auto& task : dead_letters)
+        {
+            auto&           shard = GetShard(task.id);
+            std::lock_guard _{shard.mutex};
+            shard.dead_letters.insert(task.id);
+            shard.tasks.Insert(task);
+        }
+    }
+
+    ShardedStorage::Shard& ShardedStorage::GetShard(size_t index) const
+    {
+        return m_shards[index % m_shards.size()];
+    }
+
+    std::vector<std::vector<size_t>> ShardedStorage::GroupByShard(std::span<const size_t> ids) const
+    {
+        std::vector<std::vector<size_t>> positions(m_shards.size());
+        for (size_t position = 0; position < ids.size(); ++position)
+            positions[ids[position] % m_shards.size()].push_back(position);
+        return positions;
+    }
+
+    bool ShardedStorage::Requeue(Shard& shard, size_t index)
+    {
+        const auto priority = shard.tasks.GetPriority(index);
+        if (!priority)
+            return false;
+
+        if (Push(index, priority.value()))
+            return true;
+
+        // Queue is full: task stays leased and is retried on the next expiration
+        shard.leases.Acquire(index, Clock::time_point{});
+        return false;
+    }
+
+    bool ShardedStorage::Push(size_t id, uint8_t priority)
+    {
+        std::lock_guard _{m_queue_mutex};
+        return m_queue.TryPush(id, priority);
+    }
+
+    std::optional<size_t> ShardedStorage::Pop()
+    {
+        std::lock_guard _{m_queue_mutex};
+        return m_queue.TryPop();
+    }
+
+    void ShardedStorage::DropStale()
+    {
+        std::lock_guard _{m_queue_mutex};
+        m_queue.DropStale();
+    }
+
+    bool ShardedStorage::Erase(Shard& shard, size_t index)
+    {
+        if (!shard.tasks.Erase(index))
+            return false;
+
+        // Task is either leased, dead, delayed or queued. Queued id can't be taken out of the middle of the queue, so it is marked stale
+        // to free its place at once. If a consumer has popped the id already, the consumer finds the task missing and drops the mark
+        if (shard.leases.Release(index) || shard.dead_letters.erase(index) != 0 || shard.delays.Cancel(index))
+            return false;
+
+        std::lock_guard _{m_queue_mutex};
+        m_queue.MarkStale();
+        return m_queue.HasManyStale();
+    }
+
+    void ShardedStorage::EraseStale()
+    {
+        // Shards are locked in index order and before the queue like everywhere, so tables are stable while the queue is scanned
+        std::vector<std::unique_lock<std::shared_mutex>> locks{};
+        locks.reserve(m_shards.size());
+        for (auto& shard : m_shards)
+            locks.emplace_back(shard.mutex);
+
+        std::lock_guard _{m_queue_mutex};
+        if (m_queue.HasManyStale())
+            m_queue.EraseStale([this](size_t id) { return !GetShard(id).tasks.Contains(id); });
+    }
+} // namespace backend::data_storage
@@ -0,0 +1,115 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/data_storage/delays/delays.hpp>
+#include <libraries/backend/data_storage/interface/data_storage.hpp>
+#include <libraries/backend/data_storage/leases/leases.hpp>
+#include <libraries/backend/data_storage/task_table/task_table.hpp>
+#include <libraries/utils/bucket_queue.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief In-memory storage split into independently locked shards keyed by task id.
+     * @details Ids are allocated atomically outside of any lock, so concurrent requests contend only when they touch the same shard.
+     * Queue of ids ordered by priority is shared by all shards and guarded by its own lock held for O(1) push or pop only.
+     * Delayed tasks and failed tasks waiting for their backoff are held by their shard and pushed to the queue by PromoteDelayed once they are due.
+     */
+    class ShardedStorage final : public DataStorage
+    {
+    public:
+        static constexpr size_t default_shards_count   = 16;
+        static constexpr size_t default_queue_capacity = size_t{1} << 20;
+
+        /**
+         * @param shards_count count of independently locked shards
+         * @param queue_capacity max count of tasks waiting for dequeue, CreateTask throws when it is reached
+         */
+        explicit ShardedStorage(size_t shards_count = default_shards_count, size_t queue_capacity = default_queue_capacity);
+        ~ShardedStorage() override;
+
+        Task                CreateTask(const TaskPayload& payload) override;
+        void                DeleteTask(size_t index) override;
+        std::optional<Task> GetTask(size_t index) const override;
+        std::vector<Task>   GetTasks() const override;
+        std::vector<Task>   GetTasks(std::optional<size_t> after, size_t limit) const override;
+        std::vector<Task>   CreateTasks(std::span<const TaskPayload> payloads) override;
+        std::vector<Task>   GetTasks(std::span<const size_t> ids) const override;
+        void                DeleteTasks(std::span<const size_t> ids) override;
+        std::vector<Task>   Dequeue(size_t count) override;
+        std::vector<Task>   Claim(size_t count, Clock::time_point deadline) override;
+        bool                Ack(size_t index) override;
+        bool                Nack(size_t index) override;
+        FailResult          Fail(size_t index, const RetryPolicy& policy, Clock::time_point now) override;
+        std::vector<Task>   GetDeadLetters() const override;
+        bool                Redrive(size_t index) override;
+        bool                ExtendLease(size_t index, Clock::time_point deadline) override;
+        size_t              ExpireLeases(Clock::time_point now) override;
+        size_t              PromoteDelayed(Clock::time_point now) override;
+        void                Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id) override;
+
+    private:
+        struct alignas(64) Shard
+        {
+            Shard(size_t shards_count, size_t index)
+                : tasks{shards_count, index}
+            {
+            }
+
+            mutable std::shared_mutex mutex{};
+            TaskTable                 tasks;
+            Leases                    leases{};
+            Delays                    delays{};
+            std::set<size_t>          dead_letters{};
+        };
+
+        Shard& GetShard(size_t index) const;
+
+        /**
+         * @brief Splits positions of `ids` by shards, so every shard touched by a batch is locked once
+         */
+        std::vector<std::vector<size_t>> GroupByShard(std::span<const size_t> ids) const;
+
+        bool                  Requeue(Shard& shard, size_t index);
+        bool                  Push(size_t id, uint8_t priority);
+        std::optional<size_t> Pop();
+        void                  DropStale();
+
+        /**
+         * @brief Erases task under the lock of its shard
+         * @return true if stale ids are worth erasing from the queue, it's done by EraseStale once the shard is unlocked
+         */
+        bool Erase(Shard& shard, size_t index);
+        void EraseStale();
+
+        mutable std::deque<Shard>  m_shards{};
+        std::atomic_size_t         m_id{};
+        std::mutex                 m_queue_mutex{};
+        utils::BucketQueue<size_t> m_queue;
+    };
+} // namespace backend::data_storage
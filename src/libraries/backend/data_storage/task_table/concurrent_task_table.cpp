@@ -0,0 +1,250 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "concurrent_task_table.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace backend::data_storage
+{
+    namespace
+    {
+        /**
+         * @brief Drops released pages from both ends of the directory
+         */
+        template<typename Directory>
+        void TrimReleased(Directory& directory)
+        {
+            const auto front = std::ranges::find_if(directory.pages, [](const auto* page) { return page != nullptr; });
+            directory.first_page += static_cast<size_t>(front - directory.pages.begin());
+            directory.pages.erase(directory.pages.begin(), front);
+            while (!directory.pages.empty() && !directory.pages.back())
+                directory.pages.pop_back();
+        }
+    } // namespace
+
+    ConcurrentTaskTable::ConcurrentTaskTable()
+        : m_directory{new Directory{}}
+    {
+    }
+
+    ConcurrentTaskTable::~ConcurrentTaskTable()
+    {
+        const auto* directory = m_directory.load(std::memory_order_relaxed);
+        for (auto* page : directory->pages)
+            delete page;
+        delete directory;
+    }
+
+    void ConcurrentTaskTable::Insert(const Task& task)
+    {
+        auto&       page   = GetOrCreatePage(task.id / page_size);
+        const auto& record = TaskRecord::Create(task.payload, page.arena, m_names, task.attempts);
+
+        // Replaced record stays in the page arena, so readers still copying it are safe without retiring
+        if (!page.slots[task.id % page_size].exchange(&record, std::memory_order_acq_rel))
+        {
+            ++page.alive;
+            m_size.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool ConcurrentTaskTable::Erase(size_t id)
+    {
+        auto* page = FindPage(id / page_size);
+        if (!page)
+            return false;
+
+        if (!page->slots[id % page_size].exchange(nullptr, std::memory_order_acq_rel))
+            return false;
+
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        const auto* directory = m_directory.load(std::memory_order_relaxed);
+        if (--page->alive == 0 && id / page_size != directory->first_page + directory->pages.size() - 1)
+            ReleasePage(id / page_size);
+        return true;
+    }
+
+    std::optional<Task> ConcurrentTaskTable::Extract(size_t id)
+    {
+        const auto* record = Find(id);
+        if (!record)
+            return {};
+
+        std::optional<Task> result{record->ToTask(id)};
+        Erase(id);
+        return result;
+    }
+
+    bool ConcurrentTaskTable::Contains(size_t id) const
+    {
+        return Find(id) != nullptr;
+    }
+
+    std::optional<uint8_t> ConcurrentTaskTable::GetPriority(size_t id) const
+    {
+        if (const auto* record = Find(id))
+            return record->priority;
+        return {};
+    }
+
+    const TaskRecord* ConcurrentTaskTable::Find(size_t id) const
+    {
+        const auto* page = FindPage(id / page_size);
+        return page ? page->slots[id % page_size].load(std::memory_order_relaxed) : nullptr;
+    }
+
+    std::optional<Task> ConcurrentTaskTable::Get(size_t id) const
+    {
+        const auto  guard = m_rcu.Read();
+        const auto* page  = FindPage(id / page_size);
+        if (!page)
+            return {};
+
+        if (const auto* record = page->slots[id % page_size].load(std::memory_order_acquire))
+            return record->ToTask(id);
+        return {};
+    }
+
+    std::vector<Task> ConcurrentTaskTable::Get(std::span<const size_t> ids) const
+    {
+        std::vector<Task> result{};
+        result.reserve(ids.size());
+
+        const auto guard = m_rcu.Read();
+        for (const auto id : ids)
+        {
+            const auto* page = FindPage(id / page_size);
+            if (!page)
+                continue;
+
+            if (const auto* record = page->slots[id % page_size].load(std::memory_order_acquire))
+                result.push_back(record->ToTask(id));
+        }
+        return result;
+    }
+
+    std::vector<Task> ConcurrentTaskTable::GetTasks() const
+    {
+        std::vector<Task> result{};
+        result.reserve(Size());
+        ForEachAfter({}, [&result](Task task) {
+            result.push_back(std::move(task));
+            return true;
+        });
+        return result;
+    }
+
+    std::vector<Task> ConcurrentTaskTable::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        std::vector<Task> result{};
+        if (limit == 0)
+            return result;
+
+        result.reserve(std::min(limit, Size()));
+        ForEachAfter(after, [&](Task task) {
+            result.push_back(std::move(task));
+            return result.size() < limit;
+        });
+        return result;
+    }
+
+    template<typename Fn>
+    void ConcurrentTaskTable::ForEachAfter(std::optional<size_t> after, Fn&& fn) const
+    {
+        const auto  guard      = m_rcu.Read();
+        const auto* directory  = m_directory.load(std::memory_order_acquire);
+        const auto  first_page = after ? after.value() / page_size : 0;
+        for (size_t index = first_page < directory->first_page ? 0 : first_page - directory->first_page; index < directory->pages.size(); ++index)
+        {
+            const auto* page = directory->pages[index];
+            if (!page)
+                continue;
+
+            const auto page_start = (directory->first_page + index) * page_size;
+            for (size_t i = 0; i < page_size; ++i)
+            {
+                const auto* record = page->slots[i].load(std::memory_order_acquire);
+                if (record && (!after || page_start + i > after.value()) && !fn(record->ToTask(page_start + i)))
+                    return;
+            }
+        }
+    }
+
+    ConcurrentTaskTable::Page* ConcurrentTaskTable::FindPage(size_t page_index) const
+    {
+        const auto* directory = m_directory.load(std::memory_order_acquire);
+        if (page_index < directory->first_page || page_index - directory->first_page >= directory->pages.size())
+            return nullptr;
+        return directory->pages[page_index - directory->first_page];
+    }
+
+    ConcurrentTaskTable::Page& ConcurrentTaskTable::GetOrCreatePage(size_t page_index)
+    {
+        if (auto* page = FindPage(page_index))
+            return *page;
+
+        // Directory is changed once per page_size insertions, so copying it is cheap in amortized terms
+        const auto* current   = m_directory.load(std::memory_order_relaxed);
+        auto*       directory = new Directory{*current};
+
+        // Emptied tail page is kept only while ids can still go into it, it is released by the directory change made here anyway
+        Page* released = nullptr;
+        if (!directory->pages.empty() && page_index >= directory->first_page + directory->pages.size() && directory->pages.back()->alive == 0)
+        {
+            released = std::exchange(directory->pages.back(), nullptr);
+            TrimReleased(*directory);
+        }
+
+        if (directory->pages.empty())
+            directory->first_page = page_index;
+
+        // ids are allocated before insertion, so a task may arrive into an already released front page
+        if (page_index < directory->first_page)
+        {
+            directory->pages.insert(directory->pages.begin(), directory->first_page - page_index, nullptr);
+            directory->first_page = page_index;
+        }
+        if (page_index - directory->first_page >= directory->pages.size())
+            directory->pages.resize(page_index - directory->first_page + 1);
+
+        auto*& page = directory->pages[page_index - directory->first_page];
+        page        = new Page{};
+
+        Publish(directory);
+        if (released)
+            m_rcu.Retire(released);
+        return *page;
+    }
+
+    void ConcurrentTaskTable::ReleasePage(size_t page_index)
+    {
+        const auto* current   = m_directory.load(std::memory_order_relaxed);
+        auto*       directory = new Directory{*current};
+        auto*       page      = std::exchange(directory->pages[page_index - directory->first_page], nullptr);
+        TrimReleased(*directory);
+
+        Publish(directory);
+        m_rcu.Retire(page);
+    }
+
+    void ConcurrentTaskTable::Publish(Directory* directory)
+    {
+        m_rcu.Retire(m_directory.exchange(directory, std::memory_order_acq_rel));
+    }
+} // namespace backend::data_storage
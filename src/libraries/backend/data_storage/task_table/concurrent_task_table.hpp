@@ -0,0 +1,106 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/data_storage/task_table/task_record.hpp>
+#include <libraries/backend/interface/task/task.hpp>
+#include <libraries/utils/rcu.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Container of tasks indexed by id (same page layout as TaskTable) for one writer and any count of concurrent readers.
+     * @details Slots hold atomic pointers to immutable tasks and the page directory is an immutable snapshot, writer replaces them and retires old ones through RCU.
+     * So readers (Get/GetTasks/Size) never take locks and never wait for the writer. Insert/Erase/Extract/Contains/GetPriority must be serialized externally.
+     * Tasks are kept as compact records packed into an arena of their page, so memory of erased or replaced tasks is reclaimed together with the page.
+     * Emptied tail page is kept till ids go past it, so a shallow queue doesn't copy the directory and allocate a page per task.
+     */
+    class ConcurrentTaskTable
+    {
+    public:
+        static constexpr size_t page_size = 1024;
+
+        ConcurrentTaskTable();
+        ~ConcurrentTaskTable();
+
+        ConcurrentTaskTable(const ConcurrentTaskTable&)            = delete;
+        ConcurrentTaskTable& operator=(const ConcurrentTaskTable&) = delete;
+
+        void                Insert(const Task& task);
+        bool                Erase(size_t id);
+        std::optional<Task> Extract(size_t id);
+
+        /**
+         * @brief Writer-side lookups
+         */
+        bool                   Contains(size_t id) const;
+        std::optional<uint8_t> GetPriority(size_t id) const;
+
+        std::optional<Task> Get(size_t id) const;
+        std::vector<Task>   GetTasks() const;
+
+        /**
+         * @brief Returns existing tasks among `ids` in the same order within one read-side critical section
+         */
+        std::vector<Task> Get(std::span<const size_t> ids) const;
+
+        /**
+         * @brief Returns up to `limit` tasks with id greater than `after` (all tasks if `after` is empty) in id order
+         */
+        std::vector<Task> GetTasks(std::optional<size_t> after, size_t limit) const;
+
+        size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+
+    private:
+        struct Page
+        {
+            std::array<std::atomic<const TaskRecord*>, page_size> slots{};
+            size_t                                                alive{};
+            RecordArena                                           arena{};
+        };
+
+        struct Directory
+        {
+            size_t             first_page{};
+            std::vector<Page*> pages{};
+        };
+
+        template<typename Fn>
+        void ForEachAfter(std::optional<size_t> after, Fn&& fn) const;
+
+        const TaskRecord* Find(size_t id) const;
+
+        Page* FindPage(size_t page_index) const;
+        Page& GetOrCreatePage(size_t page_index);
+        void  ReleasePage(size_t page_index);
+        void  Publish(Directory* directory);
+
+    private:
+        mutable utils::Rcu            m_rcu{};
+        std::atomic<const Directory*> m_directory;
+        std::atomic_size_t            m_size{};
+        NameInterner                  m_names{};
+    };
+} // namespace backend::data_storage
@@ -0,0 +1,118 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "task_record.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace backend::data_storage
+{
+    static_assert(alignof(TaskRecord) <= RecordArena::alignment);
+    static_assert(sizeof(TaskRecord) == 16);
+
+    std::byte* RecordArena::Allocate(size_t size)
+    {
+        size = (size + alignment - 1) / alignment * alignment;
+
+        // Oversized allocation gets a block of its own, so the rest of the current block isn't wasted
+        if (size > max_block_size)
+            return m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(size)).get();
+
+        if (size > m_left)
+        {
+            // Blocks grow geometrically up to a limit, so small tables stay small and the tail left unused in the last block stays bounded
+            const auto block_size = std::max(size, m_next_block_size);
+            m_next_block_size     = std::min(m_next_block_size * 2, max_block_size);
+
+            m_current = m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(block_size)).get();
+            m_left    = block_size;
+        }
+
+        auto* result = m_current;
+        m_current += size;
+        m_left -= size;
+        return result;
+    }
+
+    const char* NameInterner::Intern(std::string_view name)
+    {
+        if (name.empty() || name.size() > max_name_size)
+            return nullptr;
+
+        if (const auto it = m_names.find(name); it != m_names.end())
+            return it->data();
+
+        if (m_names.size() >= max_names)
+            return nullptr;
+
+        auto* data = reinterpret_cast<char*>(m_arena.Allocate(name.size()));
+        std::ranges::copy(name, data);
+        return m_names.emplace(data, name.size()).first->data();
+    }
+
+    const TaskRecord& TaskRecord::Create(const TaskPayload& payload, RecordArena& arena, NameInterner& names, uint32_t attempts)
+    {
+        if (payload.name.size() > TaskPayload::max_name_size || payload.description.size() > TaskPayload::max_description_size)
+            throw std::length_error("Task payload is too big");
+
+        const auto* interned = names.Intern(payload.name);
+        const auto  flags    = static_cast<uint8_t>((payload.run_at != 0 ? has_run_at : 0) | (attempts != 0 ? has_attempts : 0));
+        auto*       memory   = arena.Allocate(sizeof(TaskRecord) + ExtrasSize(flags) + payload.description.size() + (interned ? 0 : payload.name.size()));
+        auto*       record   = new (memory) TaskRecord{.name = interned, .description_size = static_cast<uint32_t>(payload.description.size()), .name_size = static_cast<uint16_t>(payload.name.size()), .priority = payload.priority, .flags = flags};
+
+        auto* extras = memory + sizeof(TaskRecord);
+        if (flags & has_run_at)
+        {
+            std::memcpy(extras, &payload.run_at, sizeof(uint64_t));
+            extras += sizeof(uint64_t);
+        }
+        if (flags & has_attempts)
+            std::memcpy(extras, &attempts, sizeof(uint32_t));
+
+        auto* tail = std::ranges::copy(payload.description, const_cast<char*>(record->Description().data())).out;
+        if (!interned)
+        {
+            std::ranges::copy(payload.name, tail);
+            record->name = tail;
+        }
+        return *record;
+    }
+
+    uint64_t TaskRecord::RunAt() const
+    {
+        uint64_t result{};
+        if (flags & has_run_at)
+            std::memcpy(&result, reinterpret_cast<const std::byte*>(this + 1), sizeof(uint64_t));
+        return result;
+    }
+
+    uint32_t TaskRecord::Attempts() const
+    {
+        uint32_t result{};
+        if (flags & has_attempts)
+            std::memcpy(&result, reinterpret_cast<const std::byte*>(this + 1) + ExtrasSize(static_cast<uint8_t>(flags & has_run_at)), sizeof(uint32_t));
+        return result;
+    }
+
+    Task TaskRecord::ToTask(size_t id) const
+    {
+        return Task{.id = id, .payload = {.name = std::string{Name()}, .description = std::string{Description()}, .priority = priority, .run_at = RunAt()}, .attempts = Attempts()};
+    }
+} // namespace backend::data_storage
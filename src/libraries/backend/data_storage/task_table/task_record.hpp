@@ -0,0 +1,110 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/interface/task/task.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Append-only memory handed out of growing blocks, allocated bytes never move and are freed all at once together with the arena
+     */
+    class RecordArena
+    {
+    public:
+        static constexpr size_t alignment      = alignof(uint64_t);
+        static constexpr size_t min_block_size = 1024;
+        static constexpr size_t max_block_size = 16 * 1024;
+
+        RecordArena() = default;
+
+        RecordArena(const RecordArena&)            = delete;
+        RecordArena& operator=(const RecordArena&) = delete;
+
+        /**
+         * @return uninitialized memory of `size` bytes aligned to `alignment`
+         */
+        std::byte* Allocate(size_t size);
+
+    private:
+        std::vector<std::unique_ptr<std::byte[]>> m_blocks{};
+        std::byte*                                m_current{};
+        size_t                                    m_left{};
+        size_t                                    m_next_block_size{min_block_size};
+    };
+
+    /**
+     * @brief Keeps one copy of every distinct task name, so a name shared by many tasks costs nothing per task.
+     * @details Count and length of interned names are bounded, so unique names don't make it grow forever: such names are rejected and stored next to their tasks instead.
+     */
+    class NameInterner
+    {
+    public:
+        static constexpr size_t max_names     = 4096;
+        static constexpr size_t max_name_size = 256;
+
+        /**
+         * @return stable pointer to the interned copy of `name`, nullptr if `name` is not interned
+         */
+        const char* Intern(std::string_view name);
+
+    private:
+        RecordArena                          m_arena{};
+        std::unordered_set<std::string_view> m_names{};
+    };
+
+    /**
+     * @brief Fixed-size header of a task kept in a table, description (and name if it is not interned) is placed right after it.
+     * @details Id is not stored: table derives it from position of the record.
+     * Run time of delayed tasks and attempts of failed ones are rare, so they are stored only when set: between the header and the description.
+     */
+    struct TaskRecord
+    {
+        const char* name{};
+        uint32_t    description_size{};
+        uint16_t    name_size{};
+        uint8_t     priority{};
+        uint8_t     flags{};
+
+        static constexpr uint8_t has_run_at   = 1;
+        static constexpr uint8_t has_attempts = 2;
+
+        /**
+         * @brief Packs `payload` into `arena` as a single record
+         * @throws std::length_error if name or description is longer than TaskPayload::max_name_size or TaskPayload::max_description_size
+         */
+        static const TaskRecord& Create(const TaskPayload& payload, RecordArena& arena, NameInterner& names, uint32_t attempts = 0);
+
+        std::string_view Name() const { return {name, name_size}; }
+        std::string_view Description() const { return {reinterpret_cast<const char*>(this + 1) + ExtrasSize(flags), description_size}; }
+        uint64_t         RunAt() const;
+        uint32_t         Attempts() const;
+
+        Task ToTask(size_t id) const;
+
+    private:
+        static size_t ExtrasSize(uint8_t flags) { return (flags & has_run_at ? sizeof(uint64_t) : 0) + (flags & has_attempts ? sizeof(uint32_t) : 0); }
+    };
+} // namespace backend::data_storage
@@ -0,0 +1,181 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "task_table.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace backend::data_storage
+{
+    TaskTable::TaskTable(size_t stride, size_t offset)
+        : m_stride{stride}
+        , m_offset{offset}
+    {
+        if (stride == 0)
+            throw std::invalid_argument("Stride must be positive");
+        if (offset >= stride)
+            throw std::invalid_argument("Offset must be less than stride");
+    }
+
+    void TaskTable::Insert(const Task& task)
+    {
+        if (task.id % m_stride != m_offset)
+            throw std::invalid_argument("Task id doesn't belong to the table");
+
+        const auto slot = task.id / m_stride;
+        auto&      page = GetOrCreatePage(slot / page_size);
+        auto&      item = page.slots[slot % page_size];
+        if (!item)
+        {
+            ++page.alive;
+            ++m_size;
+        }
+        item = &TaskRecord::Create(task.payload, page.arena, m_names, task.attempts);
+    }
+
+    bool TaskTable::Erase(size_t id)
+    {
+        if (!Find(id))
+            return false;
+
+        const auto slot = id / m_stride;
+        auto*      page = FindPage(slot / page_size);
+
+        page->slots[slot % page_size] = nullptr;
+        --m_size;
+        if (--page->alive == 0 && slot / page_size != m_first_page + m_pages.size() - 1)
+            ReleasePage(slot / page_size);
+        return true;
+    }
+
+    std::optional<Task> TaskTable::Extract(size_t id)
+    {
+        auto result = Get(id);
+        if (result)
+            Erase(id);
+        return result;
+    }
+
+    std::optional<Task> TaskTable::Get(size_t id) const
+    {
+        if (const auto* record = Find(id))
+            return record->ToTask(id);
+        return {};
+    }
+
+    bool TaskTable::Contains(size_t id) const
+    {
+        return Find(id) != nullptr;
+    }
+
+    std::optional<uint8_t> TaskTable::GetPriority(size_t id) const
+    {
+        if (const auto* record = Find(id))
+            return record->priority;
+        return {};
+    }
+
+    const TaskRecord* TaskTable::Find(size_t id) const
+    {
+        if (id % m_stride != m_offset)
+            return nullptr;
+
+        const auto  slot = id / m_stride;
+        const auto* page = FindPage(slot / page_size);
+        return page ? page->slots[slot % page_size] : nullptr;
+    }
+
+    std::vector<Task> TaskTable::GetTasks() const
+    {
+        std::vector<Task> result{};
+        result.reserve(m_size);
+        ForEach([&result](Task task) { result.push_back(std::move(task)); });
+        return result;
+    }
+
+    std::vector<Task> TaskTable::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        std::vector<Task> result{};
+        if (limit == 0)
+            return result;
+
+        result.reserve(std::min(limit, m_size));
+        ForEachAfter(after, [&](Task task) {
+            result.push_back(std::move(task));
+            return result.size() < limit;
+        });
+        return result;
+    }
+
+    std::vector<size_t> TaskTable::GetIds(std::optional<size_t> after, size_t limit) const
+    {
+        std::vector<size_t> result{};
+        if (limit == 0)
+            return result;
+
+        result.reserve(std::min(limit, m_size));
+        ForEachRecordAfter(after, [&](size_t id, const TaskRecord&) {
+            result.push_back(id);
+            return result.size() < limit;
+        });
+        return result;
+    }
+
+    TaskTable::Page* TaskTable::FindPage(size_t page_index) const
+    {
+        if (page_index < m_first_page || page_index - m_first_page >= m_pages.size())
+            return nullptr;
+        return m_pages[page_index - m_first_page].get();
+    }
+
+    TaskTable::Page& TaskTable::GetOrCreatePage(size_t page_index)
+    {
+        // Emptied tail page is kept only while ids can still go into it
+        if (!m_pages.empty() && page_index >= m_first_page + m_pages.size() && m_pages.back()->alive == 0)
+            ReleasePage(m_first_page + m_pages.size() - 1);
+
+        if (m_pages.empty())
+            m_first_page = page_index;
+
+        // ids are allocated before insertion, so a task may arrive into an already released front page
+        for (; page_index < m_first_page; --m_first_page)
+            m_pages.emplace_front();
+
+        if (page_index - m_first_page >= m_pages.size())
+            m_pages.resize(page_index - m_first_page + 1);
+
+        auto& page = m_pages[page_index - m_first_page];
+        if (!page)
+            page = std::make_unique<Page>();
+        return *page;
+    }
+
+    void TaskTable::ReleasePage(size_t page_index)
+    {
+        m_pages[page_index - m_first_page].reset();
+
+        while (!m_pages.empty() && !m_pages.front())
+        {
+            m_pages.pop_front();
+            ++m_first_page;
+        }
+        while (!m_pages.empty() && !m_pages.back())
+            m_pages.pop_back();
+    }
+} // namespace backend::data_storage
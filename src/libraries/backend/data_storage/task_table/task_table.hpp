@@ -0,0 +1,135 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/data_storage/task_table/task_record.hpp>
+#include <libraries/backend/interface/task/task.hpp>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Not thread-safe container of tasks indexed directly by task id.
+     * @details Tasks are stored in fixed-size pages of slots, so get/insert/erase are O(1) and iteration follows id order.
+     * Erased tasks leave tombstones, a page is released as soon as its last task is erased. The tail page is an exception: new ids go into it,
+     * so it is kept till ids go past it, otherwise a shallow queue would allocate a page per task.
+     * Table can hold every `stride`-th id starting from `offset` only (e.g. ids of one shard) without wasting slots for the rest.
+     * Tasks are kept as compact records packed into an arena of their page, so memory of erased or replaced tasks is reclaimed together with the page.
+     */
+    class TaskTable
+    {
+    public:
+        static constexpr size_t page_size = 1024;
+
+        explicit TaskTable(size_t stride = 1, size_t offset = 0);
+
+        /**
+         * @throws std::invalid_argument if id of the task doesn't belong to the table
+         */
+        void                Insert(const Task& task);
+        bool                Erase(size_t id);
+        std::optional<Task> Extract(size_t id);
+        std::optional<Task> Get(size_t id) const;
+        bool                Contains(size_t id) const;
+
+        std::optional<uint8_t> GetPriority(size_t id) const;
+
+        size_t Size() const { return m_size; }
+
+        std::vector<Task> GetTasks() const;
+
+        /**
+         * @brief Returns up to `limit` tasks with id greater than `after` (all tasks if `after` is empty) in id order
+         */
+        std::vector<Task> GetTasks(std::optional<size_t> after, size_t limit) const;
+
+        template<typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            ForEachAfter({}, [&fn](Task task) {
+                fn(std::move(task));
+                return true;
+            });
+        }
+
+        /**
+         * @brief Visits tasks with id greater than `after` in id order until `fn` returns false
+         * @details Pages before `after` are skipped without being touched, so cost is proportional to the visited window only
+         */
+        template<typename Fn>
+        void ForEachAfter(std::optional<size_t> after, Fn&& fn) const
+        {
+            ForEachRecordAfter(after, [&fn](size_t id, const TaskRecord& record) { return fn(record.ToTask(id)); });
+        }
+
+        /**
+         * @brief Returns up to `limit` ids greater than `after` (all ids if `after` is empty) in id order, tasks themselves are not copied
+         */
+        std::vector<size_t> GetIds(std::optional<size_t> after, size_t limit) const;
+
+    private:
+        struct Page
+        {
+            std::array<const TaskRecord*, page_size> slots{};
+            size_t                                   alive{};
+            RecordArena                              arena{};
+        };
+
+        template<typename Fn>
+        void ForEachRecordAfter(std::optional<size_t> after, Fn&& fn) const
+        {
+            const auto first_slot = after ? after.value() / m_stride : 0;
+            const auto first_page = first_slot / page_size;
+            for (size_t index = first_page < m_first_page ? 0 : first_page - m_first_page; index < m_pages.size(); ++index)
+            {
+                const auto& page = m_pages[index];
+                if (!page)
+                    continue;
+
+                const auto page_start = (m_first_page + index) * page_size;
+                for (size_t i = 0; i < page_size; ++i)
+                {
+                    const auto id = ToId(page_start + i);
+                    if (page->slots[i] && (!after || id > after.value()) && !fn(id, *page->slots[i]))
+                        return;
+                }
+            }
+        }
+
+        const TaskRecord* Find(size_t id) const;
+        size_t            ToId(size_t slot) const { return slot * m_stride + m_offset; }
+
+        Page* FindPage(size_t page_index) const;
+        Page& GetOrCreatePage(size_t page_index);
+        void  ReleasePage(size_t page_index);
+
+    private:
+        size_t                            m_stride;
+        size_t                            m_offset;
+        std::deque<std::unique_ptr<Page>> m_pages{};
+        size_t                            m_first_page{};
+        size_t                            m_size{};
+        NameInterner                      m_names{};
+    };
+} // namespace backend::data_storage
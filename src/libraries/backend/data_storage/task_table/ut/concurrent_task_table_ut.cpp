@@ -0,0 +1,175 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/data_storage/task_table/concurrent_task_table.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    backend::Task MakeTask(size_t id)
+    {
+        return backend::Task{.id = id, .payload = {.name = "name" + std::to_string(id)}};
+    }
+} // namespace
+
+TEST_CASE("ConcurrentTaskTable keeps tasks indexed by id")
+{
+    backend::data_storage::ConcurrentTaskTable table{};
+
+    SUBCASE("empty table")
+    {
+        CHECK(table.Size() == 0);
+        CHECK(!table.Get(0).has_value());
+        CHECK(!table.Contains(0));
+        CHECK(!table.Erase(0));
+        CHECK(table.GetTasks().empty());
+    }
+
+    SUBCASE("tasks spread over several pages")
+    {
+        constexpr size_t count = backend::data_storage::ConcurrentTaskTable::page_size * 3 + 5;
+        for (size_t i = 0; i < count; ++i)
+            table.Insert(MakeTask(i));
+
+        REQUIRE(table.Size() == count);
+        REQUIRE(table.Get(count - 1) == MakeTask(count - 1));
+        REQUIRE(table.Contains(count - 1));
+        REQUIRE(!table.Get(count).has_value());
+
+        SUBCASE("extract task")
+        {
+            REQUIRE(table.Extract(10) == MakeTask(10));
+            REQUIRE(!table.Get(10).has_value());
+            REQUIRE(!table.Extract(10).has_value());
+            REQUIRE(table.Size() == count - 1);
+        }
+
+        SUBCASE("replace task")
+        {
+            auto task         = MakeTask(10);
+            task.payload.name = "replaced";
+            table.Insert(task);
+            REQUIRE(table.Get(10) == task);
+            REQUIRE(table.Size() == count);
+        }
+
+        SUBCASE("erase from front releases pages and keeps order")
+        {
+            for (size_t i = 0; i < backend::data_storage::ConcurrentTaskTable::page_size + 1; ++i)
+                REQUIRE(table.Erase(i));
+
+            const auto tasks = table.GetTasks();
+            REQUIRE(tasks.size() == table.Size());
+            REQUIRE(tasks.front() == MakeTask(backend::data_storage::ConcurrentTaskTable::page_size + 1));
+            REQUIRE(tasks.back() == MakeTask(count - 1));
+
+            table.Insert(MakeTask(3));
+            REQUIRE(table.GetTasks().front() == MakeTask(3));
+        }
+
+        SUBCASE("window after id")
+        {
+            REQUIRE(table.GetTasks({}, 2) == std::vector{MakeTask(0), MakeTask(1)});
+            REQUIRE(table.GetTasks(backend::data_storage::ConcurrentTaskTable::page_size - 1, 1) == std::vector{MakeTask(backend::data_storage::ConcurrentTaskTable::page_size)});
+            REQUIRE(table.GetTasks(count - 1, 10).empty());
+        }
+
+        SUBCASE("get batch by ids")
+        {
+            table.Erase(5);
+            const std::vector<size_t> ids{count - 1, 5, 0, count, 0};
+            REQUIRE(table.Get(ids) == std::vector{MakeTask(count - 1), MakeTask(0), MakeTask(0)});
+        }
+
+        SUBCASE("erase everything")
+        {
+            for (size_t i = count; i > 0; --i)
+                REQUIRE(table.Erase(i - 1));
+
+            REQUIRE(table.Size() == 0);
+            REQUIRE(table.GetTasks().empty());
+
+            table.Insert(MakeTask(count * 10));
+            REQUIRE(table.GetTasks() == std::vector{MakeTask(count * 10)});
+        }
+    }
+
+    SUBCASE("shallow queue")
+    {
+        // Every task is erased before the next one is inserted, so pages are emptied one after another
+        constexpr size_t count = backend::data_storage::ConcurrentTaskTable::page_size * 3;
+        for (size_t i = 0; i < count; ++i)
+        {
+            table.Insert(MakeTask(i));
+            REQUIRE(table.Extract(i) == MakeTask(i));
+        }
+        REQUIRE(table.Size() == 0);
+        REQUIRE(table.GetTasks().empty());
+
+        table.Insert(MakeTask(count));
+        table.Insert(MakeTask(1));
+        REQUIRE(table.GetTasks() == std::vector{MakeTask(1), MakeTask(count)});
+    }
+}
+
+TEST_CASE("ConcurrentTaskTable readers see consistent tasks while writer mutates")
+{
+    constexpr size_t readers_count = 4;
+    constexpr size_t count         = backend::data_storage::ConcurrentTaskTable::page_size * 20;
+
+    backend::data_storage::ConcurrentTaskTable table{};
+    std::atomic_bool                           done{};
+    std::atomic_size_t                         failures{};
+    {
+        std::vector<std::jthread> readers{};
+        for (size_t r = 0; r < readers_count; ++r)
+        {
+            readers.emplace_back([&, r] {
+                for (size_t i = r; !done; i += 7)
+                {
+                    if (const auto task = table.Get(i % count); task && task.value() != MakeTask(i % count))
+                        ++failures;
+
+                    const auto tasks = table.GetTasks(i % count, 100);
+                    for (size_t j = 0; j < tasks.size(); ++j)
+                    {
+                        if (tasks[j] != MakeTask(tasks[j].id) || tasks[j].id <= i % count || (j > 0 && tasks[j].id <= tasks[j - 1].id))
+                            ++failures;
+                    }
+                }
+            });
+        }
+
+        // Sliding window of alive tasks makes pages and directory to be created and released all the time
+        constexpr size_t window = backend::data_storage::ConcurrentTaskTable::page_size * 2;
+        for (size_t i = 0; i < count; ++i)
+        {
+            table.Insert(MakeTask(i));
+            if (i >= window)
+                REQUIRE(table.Extract(i - window) == MakeTask(i - window));
+        }
+        done = true;
+    }
+    REQUIRE(failures == 0);
+    REQUIRE(table.Size() == backend::data_storage::ConcurrentTaskTable::page_size * 2);
+}
@@ -0,0 +1,112 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/data_storage/task_table/task_record.hpp>
+
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("TaskRecord packs task payload into arena")
+{
+    backend::data_storage::RecordArena  arena{};
+    backend::data_storage::NameInterner names{};
+
+    SUBCASE("round trip")
+    {
+        const backend::TaskPayload payload{.name = "name", .description = "description", .priority = 200};
+        REQUIRE(backend::data_storage::TaskRecord::Create(payload, arena, names).ToTask(7) == backend::Task{.id = 7, .payload = payload});
+    }
+
+    SUBCASE("delayed task round trip")
+    {
+        const backend::TaskPayload payload{.name = std::string(backend::data_storage::NameInterner::max_name_size + 1, 'n'), .description = "description", .run_at = 1'700'000'000'123};
+        const auto&                record = backend::data_storage::TaskRecord::Create(payload, arena, names);
+        REQUIRE(record.RunAt() == payload.run_at);
+        REQUIRE(record.ToTask(7) == backend::Task{.id = 7, .payload = payload});
+    }
+
+    SUBCASE("retried task round trip")
+    {
+        const backend::TaskPayload payload{.name = "name", .description = "description"};
+        const auto&                record = backend::data_storage::TaskRecord::Create(payload, arena, names, 3);
+        REQUIRE(record.Attempts() == 3);
+        REQUIRE(record.ToTask(7) == backend::Task{.id = 7, .payload = payload, .attempts = 3});
+
+        const backend::TaskPayload delayed{.name = "name", .description = "description", .run_at = 1'700'000'000'123};
+        REQUIRE(backend::data_storage::TaskRecord::Create(delayed, arena, names, 3).ToTask(7) == backend::Task{.id = 7, .payload = delayed, .attempts = 3});
+    }
+
+    SUBCASE("empty payload")
+    {
+        REQUIRE(backend::data_storage::TaskRecord::Create({}, arena, names).ToTask(1) == backend::Task{.id = 1});
+    }
+
+    SUBCASE("repeated names are shared")
+    {
+        const auto& first  = backend::data_storage::TaskRecord::Create({.name = "name", .description = "first"}, arena, names);
+        const auto& second = backend::data_storage::TaskRecord::Create({.name = "name", .description = "second"}, arena, names);
+        REQUIRE(first.name == second.name);
+        REQUIRE(first.Description() == "first");
+        REQUIRE(second.Description() == "second");
+    }
+
+    SUBCASE("long names are stored next to their tasks")
+    {
+        const std::string name(backend::data_storage::NameInterner::max_name_size + 1, 'n');
+        const auto&       first  = backend::data_storage::TaskRecord::Create({.name = name}, arena, names);
+        const auto&       second = backend::data_storage::TaskRecord::Create({.name = name}, arena, names);
+        REQUIRE(first.name != second.name);
+        REQUIRE(first.Name() == name);
+        REQUIRE(second.Name() == name);
+    }
+
+    SUBCASE("too long name")
+    {
+        REQUIRE_THROWS_AS(backend::data_storage::TaskRecord::Create({.name = std::string(size_t{1} << 16, 'n')}, arena, names), std::length_error);
+    }
+
+    SUBCASE("descriptions bigger than the first arena block")
+    {
+        const std::string description(backend::data_storage::RecordArena::min_block_size * 3, 'd');
+        const auto&       first  = backend::data_storage::TaskRecord::Create({.description = description}, arena, names);
+        const auto&       second = backend::data_storage::TaskRecord::Create({.description = description}, arena, names);
+        REQUIRE(first.Description() == description);
+        REQUIRE(second.Description() == description);
+    }
+
+    SUBCASE("descriptions bigger than arena block")
+    {
+        const std::string description(backend::data_storage::RecordArena::max_block_size * 2, 'd');
+        const auto&       big   = backend::data_storage::TaskRecord::Create({.name = "name", .description = description}, arena, names);
+        const auto&       small = backend::data_storage::TaskRecord::Create({.name = "name", .description = "small"}, arena, names);
+        REQUIRE(big.Description() == description);
+        REQUIRE(small.Description() == "small");
+    }
+}
+
+TEST_CASE("NameInterner is bounded")
+{
+    backend::data_storage::NameInterner names{};
+    for (size_t i = 0; i < backend::data_storage::NameInterner::max_names; ++i)
+        REQUIRE(names.Intern(std::to_string(i)) != nullptr);
+
+    REQUIRE(names.Intern("0") == names.Intern("0"));
+    REQUIRE(names.Intern("new") == nullptr);
+    REQUIRE(names.Intern("") == nullptr);
+}
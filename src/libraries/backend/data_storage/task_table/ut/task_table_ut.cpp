@@ -0,0 +1,153 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/data_storage/task_table/task_table.hpp>
+
+#include <stdexcept>
+
+namespace
+{
+    backend::Task MakeTask(size_t id)
+    {
+        return backend::Task{.id = id, .payload = {.name = "name" + std::to_string(id)}};
+    }
+} // namespace
+
+TEST_CASE("TaskTable keeps tasks indexed by id")
+{
+    backend::data_storage::TaskTable table{};
+
+    SUBCASE("empty table")
+    {
+        CHECK(table.Size() == 0);
+        CHECK(!table.Contains(0));
+        CHECK(!table.Erase(0));
+        CHECK(table.GetTasks().empty());
+    }
+
+    SUBCASE("tasks spread over several pages")
+    {
+        constexpr size_t count = backend::data_storage::TaskTable::page_size * 3 + 5;
+        for (size_t i = 0; i < count; ++i)
+            table.Insert(MakeTask(i));
+
+        REQUIRE(table.Size() == count);
+        REQUIRE(table.Get(count - 1) == MakeTask(count - 1));
+        REQUIRE(!table.Contains(count));
+
+        SUBCASE("extract task")
+        {
+            REQUIRE(table.Extract(10) == MakeTask(10));
+            REQUIRE(!table.Contains(10));
+            REQUIRE(!table.Extract(10).has_value());
+            REQUIRE(table.Size() == count - 1);
+        }
+
+        SUBCASE("erase from front releases pages and keeps order")
+        {
+            for (size_t i = 0; i < backend::data_storage::TaskTable::page_size + 1; ++i)
+                REQUIRE(table.Erase(i));
+
+            REQUIRE(table.Size() == count - backend::data_storage::TaskTable::page_size - 1);
+            REQUIRE(!table.Contains(0));
+            REQUIRE(!table.Erase(0));
+
+            const auto tasks = table.GetTasks();
+            REQUIRE(tasks.size() == table.Size());
+            REQUIRE(tasks.front() == MakeTask(backend::data_storage::TaskTable::page_size + 1));
+            REQUIRE(tasks.back() == MakeTask(count - 1));
+
+            SUBCASE("late insertion into released page")
+            {
+                table.Insert(MakeTask(3));
+                REQUIRE(table.Get(3) == MakeTask(3));
+                REQUIRE(table.GetTasks().front() == MakeTask(3));
+            }
+        }
+
+        SUBCASE("window after id")
+        {
+            REQUIRE(table.GetTasks({}, 2) == std::vector{MakeTask(0), MakeTask(1)});
+            REQUIRE(table.GetTasks(backend::data_storage::TaskTable::page_size - 2, 3) == std::vector{MakeTask(backend::data_storage::TaskTable::page_size - 1), MakeTask(backend::data_storage::TaskTable::page_size), MakeTask(backend::data_storage::TaskTable::page_size + 1)});
+            REQUIRE(table.GetTasks(count - 2, 10) == std::vector{MakeTask(count - 1)});
+            REQUIRE(table.GetTasks(count - 1, 10).empty());
+            REQUIRE(table.GetTasks({}, 0).empty());
+
+            REQUIRE(table.Erase(5));
+            REQUIRE(table.Erase(6));
+            REQUIRE(table.GetTasks(4, 2) == std::vector{MakeTask(7), MakeTask(8)});
+        }
+
+        SUBCASE("erase everything")
+        {
+            for (size_t i = count; i > 0; --i)
+                REQUIRE(table.Erase(i - 1));
+
+            REQUIRE(table.Size() == 0);
+            REQUIRE(table.GetTasks().empty());
+
+            table.Insert(MakeTask(count * 10));
+            REQUIRE(table.GetTasks() == std::vector{MakeTask(count * 10)});
+        }
+    }
+
+    SUBCASE("shallow queue")
+    {
+        // Every task is erased before the next one is inserted, so pages are emptied one after another
+        constexpr size_t count = backend::data_storage::TaskTable::page_size * 3;
+        for (size_t i = 0; i < count; ++i)
+        {
+            table.Insert(MakeTask(i));
+            REQUIRE(table.Extract(i) == MakeTask(i));
+        }
+        REQUIRE(table.Size() == 0);
+        REQUIRE(table.GetTasks().empty());
+
+        table.Insert(MakeTask(count));
+        table.Insert(MakeTask(1));
+        REQUIRE(table.GetTasks() == std::vector{MakeTask(1), MakeTask(count)});
+    }
+
+    SUBCASE("out of order insertion")
+    {
+        table.Insert(MakeTask(5000));
+        table.Insert(MakeTask(2));
+        table.Insert(MakeTask(7));
+        REQUIRE(table.GetTasks() == std::vector{MakeTask(2), MakeTask(7), MakeTask(5000)});
+    }
+}
+
+TEST_CASE("TaskTable with stride")
+{
+    backend::data_storage::TaskTable table{4, 1};
+    for (size_t i = 1; i < 4 * backend::data_storage::TaskTable::page_size * 2; i += 4)
+        table.Insert(MakeTask(i));
+
+    REQUIRE(table.Size() == backend::data_storage::TaskTable::page_size * 2);
+    REQUIRE(table.Get(5) == MakeTask(5));
+    REQUIRE(!table.Contains(4));
+    REQUIRE(!table.Erase(4));
+    REQUIRE(table.Erase(5));
+    REQUIRE(!table.Contains(5));
+
+    REQUIRE(table.GetTasks(2, 2) == std::vector{MakeTask(9), MakeTask(13)});
+    REQUIRE(table.GetTasks(9, 1) == std::vector{MakeTask(13)});
+    REQUIRE(table.GetIds(2, 3) == std::vector<size_t>{9, 13, 17});
+    REQUIRE_THROWS_AS(table.Insert(MakeTask(6)), std::invalid_argument);
+}
@@ -17,7 +17,27 @@
 
 #include <doctest/doctest.h>
 
+#include <libraries/backend/data_storage/combining_storage/combining_storage.hpp>
 #include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/data_storage/sharded_storage/sharded_storage.hpp>
+#include <libraries/backend/data_storage/wal_storage/wal_storage.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // Every test starts from an empty log
+    backend::data_storage::WalStorage::Config MakeWalConfig()
+    {
+        const auto directory = std::filesystem::temp_directory_path() / "storages_ut_wal";
+        std::filesystem::remove_all(directory);
+        return {.directory = directory};
+    }
+} // namespace
 
 TEST_CASE("every storage satisfy storage requirements")
 {
@@ -52,6 +72,34 @@ TEST_CASE("every storage satisfy storage requirements")
             {
                 storage.DeleteTask(0);
                 REQUIRE(storage.GetTasks() == std::vector{task_1});
+
+                SUBCASE("dequeue skips deleted task")
+                {
+                    REQUIRE(storage.Dequeue(2) == std::vector{task_1});
+                    REQUIRE(storage.GetTasks() == std::vector<backend::Task>{});
+                }
+            }
+
+            SUBCASE("dequeue one by one")
+            {
+                REQUIRE(storage.Dequeue(1) == std::vector{task_0});
+                REQUIRE(storage.GetTasks() == std::vector{task_1});
+                REQUIRE(!storage.GetTask(0).has_value());
+
+                REQUIRE(storage.Dequeue(1) == std::vector{task_1});
+                REQUIRE(storage.Dequeue(1) == std::vector<backend::Task>{});
+            }
+
+            SUBCASE("dequeue more than available")
+            {
+                REQUIRE(storage.Dequeue(10) == std::vector{task_0, task_1});
+                REQUIRE(storage.GetTasks() == std::vector<backend::Task>{});
+            }
+
+            SUBCASE("dequeue nothing")
+            {
+                REQUIRE(storage.Dequeue(0) == std::vector<backend::Task>{});
+                REQUIRE(storage.GetTasks() == std::vector{task_0, task_1});
             }
 
             SUBCASE("delete non-existing task")
@@ -91,4 +139,687 @@ TEST_CASE("every storage satisfy storage requirements")
     {
         test(backend::data_storage::InMemoryStorage{});
     }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+
+    SUBCASE("ShardedStorage with single shard")
+    {
+        test(backend::data_storage::ShardedStorage{1});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage handles concurrent access")
+{
+    constexpr size_t threads_count    = 8;
+    constexpr size_t tasks_per_thread = 1000;
+
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        std::vector<std::thread> threads{};
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&storage] {
+                for (size_t j = 0; j < tasks_per_thread; ++j)
+                {
+                    const auto task = storage.CreateTask(backend::TaskPayload{.name = "name"});
+                    CHECK(storage.GetTask(task.id) == task);
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        const auto tasks = storage.GetTasks();
+        REQUIRE(tasks.size() == threads_count * tasks_per_thread);
+        for (size_t i = 0; i < tasks.size(); ++i)
+            REQUIRE(tasks[i].id == i);
+
+        std::vector<std::vector<backend::Task>> dequeued(threads_count);
+        threads.clear();
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&storage, &result = dequeued[i]] {
+                while (true)
+                {
+                    auto batch = storage.Dequeue(7);
+                    if (batch.empty())
+                        break;
+                    result.insert(result.end(), batch.begin(), batch.end());
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        std::set<size_t> ids{};
+        for (const auto& thread_tasks : dequeued)
+            for (const auto& task : thread_tasks)
+                REQUIRE(ids.insert(task.id).second);
+        REQUIRE(ids.size() == threads_count * tasks_per_thread);
+        REQUIRE(storage.GetTasks().empty());
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage pages tasks by cursor")
+{
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        for (size_t i = 0; i < 100; ++i)
+            storage.CreateTask(backend::TaskPayload{.name = std::to_string(i)});
+        for (size_t i = 0; i < 100; i += 3)
+            storage.DeleteTask(i);
+
+        SUBCASE("window after id")
+        {
+            REQUIRE(storage.GetTasks({}, 3) == std::vector{storage.GetTask(1).value(), storage.GetTask(2).value(), storage.GetTask(4).value()});
+            REQUIRE(storage.GetTasks(2, 2) == std::vector{storage.GetTask(4).value(), storage.GetTask(5).value()});
+            REQUIRE(storage.GetTasks(96, 10) == std::vector{storage.GetTask(97).value(), storage.GetTask(98).value()});
+            REQUIRE(storage.GetTasks(98, 10).empty());
+            REQUIRE(storage.GetTasks({}, 0).empty());
+        }
+
+        SUBCASE("pages cover every task once")
+        {
+            std::vector<backend::Task> tasks{};
+            std::optional<size_t>      after{};
+            while (true)
+            {
+                const auto page = storage.GetTasks(after, 7);
+                if (page.empty())
+                    break;
+                REQUIRE(page.size() <= 7);
+                tasks.insert(tasks.end(), page.begin(), page.end());
+                after = page.back().id;
+            }
+            REQUIRE(tasks == storage.GetTasks());
+        }
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+
+    SUBCASE("ShardedStorage with single shard")
+    {
+        test(backend::data_storage::ShardedStorage{1});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage rejects tasks above queue capacity")
+{
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        for (size_t i = 0; i < 4; ++i)
+            storage.CreateTask(backend::TaskPayload{});
+
+        REQUIRE_THROWS_AS(storage.CreateTask(backend::TaskPayload{}), std::length_error);
+        REQUIRE(storage.GetTasks().size() == 4);
+
+        REQUIRE(storage.Dequeue(1).size() == 1);
+        storage.CreateTask(backend::TaskPayload{});
+        REQUIRE(storage.GetTasks().size() == 4);
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{4});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{4, 4});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::InMemoryStorage>(4), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>(4)});
+    }
+}
+
+TEST_CASE("every storage restores tasks above queue capacity")
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const std::vector<backend::Task> tasks{{.id = 0, .payload = {.name = "0"}}, {.id = 1, .payload = {.name = "1"}}, {.id = 2, .payload = {.name = "2"}}};
+        storage.Restore(tasks, {}, tasks.size());
+        REQUIRE(storage.GetTasks() == tasks);
+
+        // Overflow waits for free capacity as tasks failed on the full queue do
+        REQUIRE(storage.Dequeue(10).size() == 2);
+        REQUIRE(storage.PromoteDelayed(backend::Clock::now() + 1s) == 1);
+        REQUIRE(storage.Dequeue(10).size() == 1);
+        REQUIRE(storage.CreateTask(backend::TaskPayload{}).id == tasks.size());
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{2});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{4, 2});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::InMemoryStorage>(2), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>(2)});
+    }
+}
+
+TEST_CASE("every storage frees queue capacity of deleted tasks")
+{
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const auto first  = storage.CreateTask(backend::TaskPayload{.name = "first"});
+        const auto second = storage.CreateTask(backend::TaskPayload{.name = "second", .priority = 1});
+
+        // Far more creates than capacity, so stale ids of deleted tasks are erased from the queue on the way
+        for (size_t i = 0; i < 500; ++i)
+        {
+            const auto deleted = storage.CreateTasks(std::vector{backend::TaskPayload{}, backend::TaskPayload{}});
+            REQUIRE(deleted.size() == 2);
+
+            storage.DeleteTask(deleted[0].id);
+            storage.DeleteTasks(std::vector{deleted[1].id});
+        }
+
+        REQUIRE(storage.GetTasks() == std::vector{first, second});
+        storage.CreateTask(backend::TaskPayload{});
+        storage.CreateTask(backend::TaskPayload{});
+        REQUIRE_THROWS_AS(storage.CreateTask(backend::TaskPayload{}), std::length_error);
+
+        const auto dequeued = storage.Dequeue(10);
+        REQUIRE(dequeued.size() == 4);
+        REQUIRE(dequeued[0] == second);
+        REQUIRE(dequeued[1] == first);
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{4});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{4, 4});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(4, 4), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>(4)});
+    }
+}
+
+TEST_CASE("every storage handles batches")
+{
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        std::vector<backend::TaskPayload> payloads{};
+        for (size_t i = 0; i < 40; ++i)
+            payloads.push_back(backend::TaskPayload{.name = std::to_string(i)});
+
+        const auto created = storage.CreateTasks(payloads);
+        REQUIRE(created.size() == payloads.size());
+        for (size_t i = 0; i < created.size(); ++i)
+        {
+            REQUIRE(created[i].id == i);
+            REQUIRE(created[i].payload == payloads[i]);
+        }
+        REQUIRE(storage.GetTasks() == created);
+        REQUIRE(storage.CreateTasks({}).empty());
+
+        SUBCASE("get keeps order of ids and skips missing ones")
+        {
+            const std::vector<size_t> ids{39, 3, 1000, 17, 3};
+            REQUIRE(storage.GetTasks(ids) == std::vector{created[39], created[3], created[17], created[3]});
+        }
+
+        SUBCASE("deleted tasks are neither returned nor dequeued")
+        {
+            const std::vector<size_t> ids{0, 5, 6, 1000, 39};
+            storage.DeleteTasks(ids);
+            REQUIRE(storage.GetTasks(ids).empty());
+            REQUIRE(storage.GetTasks().size() == created.size() - 4);
+
+            const auto dequeued = storage.Dequeue(created.size());
+            REQUIRE(dequeued.size() == created.size() - 4);
+            REQUIRE(dequeued.front() == created[1]);
+        }
+
+        SUBCASE("leased tasks are deleted too")
+        {
+            REQUIRE(storage.Claim(2, backend::Clock::now()).size() == 2);
+            const std::vector<size_t> ids{0, 1};
+            storage.DeleteTasks(ids);
+            REQUIRE(storage.ExpireLeases(backend::Clock::now() + std::chrono::hours{1}) == 0);
+            REQUIRE(storage.Dequeue(1) == std::vector{created[2]});
+        }
+
+        SUBCASE("next ids follow the batch")
+        {
+            REQUIRE(storage.CreateTask(backend::TaskPayload{}).id == created.size());
+        }
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+
+    SUBCASE("ShardedStorage with single shard")
+    {
+        test(backend::data_storage::ShardedStorage{1});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage creates only a prefix of batch above queue capacity")
+{
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const std::vector<backend::TaskPayload> payloads(6);
+        REQUIRE(storage.CreateTasks(payloads).size() == 4);
+        REQUIRE(storage.GetTasks().size() == 4);
+        REQUIRE(storage.CreateTasks(payloads).empty());
+
+        REQUIRE(storage.Dequeue(4).size() == 4);
+        REQUIRE(storage.CreateTasks(payloads).size() == 4);
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{4});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{4, 4});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::InMemoryStorage>(4), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>(4)});
+    }
+}
+
+TEST_CASE("every storage leases claimed tasks")
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const auto now    = backend::Clock::now();
+        const auto task_0 = storage.CreateTask(backend::TaskPayload{.name = "name0"});
+        const auto task_1 = storage.CreateTask(backend::TaskPayload{.name = "name1"});
+
+        REQUIRE(storage.Claim(1, now + 10s) == std::vector{task_0});
+        REQUIRE(storage.GetTasks() == std::vector{task_0, task_1});
+
+        SUBCASE("leased task is hidden from other consumers")
+        {
+            REQUIRE(storage.Claim(10, now + 10s) == std::vector{task_1});
+            REQUIRE(storage.Claim(10, now + 10s).empty());
+            REQUIRE(storage.Dequeue(10).empty());
+        }
+
+        SUBCASE("ack removes task")
+        {
+            REQUIRE(storage.Ack(task_0.id));
+            REQUIRE(!storage.Ack(task_0.id));
+            REQUIRE(storage.GetTasks() == std::vector{task_1});
+            REQUIRE(storage.ExpireLeases(now + 1h) == 0);
+        }
+
+        SUBCASE("nack returns task to the queue")
+        {
+            REQUIRE(storage.Nack(task_0.id));
+            REQUIRE(!storage.Nack(task_0.id));
+            REQUIRE(storage.Dequeue(10) == std::vector{task_1, task_0});
+        }
+
+        SUBCASE("expired lease returns task to the queue")
+        {
+            REQUIRE(storage.ExpireLeases(now + 9s) == 0);
+            REQUIRE(storage.ExpireLeases(now + 10s) == 1);
+            REQUIRE(!storage.Ack(task_0.id));
+            REQUIRE(storage.Claim(10, now + 20s) == std::vector{task_1, task_0});
+        }
+
+        SUBCASE("extended lease expires later")
+        {
+            REQUIRE(storage.ExtendLease(task_0.id, now + 20s));
+            REQUIRE(!storage.ExtendLease(task_1.id, now + 20s));
+            REQUIRE(storage.ExpireLeases(now + 10s) == 0);
+            REQUIRE(storage.ExpireLeases(now + 20s) == 1);
+        }
+
+        SUBCASE("deleted task is not returned to the queue")
+        {
+            storage.DeleteTask(task_0.id);
+            REQUIRE(!storage.Ack(task_0.id));
+            REQUIRE(storage.ExpireLeases(now + 1h) == 0);
+            REQUIRE(storage.Dequeue(10) == std::vector{task_1});
+        }
+
+        SUBCASE("unknown task is not leased")
+        {
+            REQUIRE(!storage.Ack(1000));
+            REQUIRE(!storage.Nack(1000));
+            REQUIRE(!storage.ExtendLease(1000, now + 1h));
+        }
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage retries failed tasks with backoff and moves them to dead letters")
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const auto                 now    = backend::Clock::now();
+        const backend::RetryPolicy policy{.max_attempts = 2, .backoff = 1s};
+        const auto                 task_0 = storage.CreateTask(backend::TaskPayload{.name = "name0"});
+        const auto                 task_1 = storage.CreateTask(backend::TaskPayload{.name = "name1"});
+
+        REQUIRE(storage.Claim(1, now + 10s) == std::vector{task_0});
+        REQUIRE(storage.Fail(task_0.id, policy, now) == backend::FailResult::Retried);
+        REQUIRE(storage.Fail(task_0.id, policy, now) == backend::FailResult::NotLeased);
+
+        auto retried     = task_0;
+        retried.attempts = 1;
+        REQUIRE(storage.GetTask(task_0.id) == retried);
+        REQUIRE(storage.PromoteDelayed(now + 500ms) == 0);
+        REQUIRE(storage.Claim(10, now + 10s) == std::vector{task_1});
+        REQUIRE(storage.PromoteDelayed(now + 1s) == 1);
+        REQUIRE(storage.Claim(10, now + 10s) == std::vector{retried});
+
+        SUBCASE("lease expiry is not an attempt")
+        {
+            REQUIRE(storage.ExpireLeases(now + 10s) == 2);
+            REQUIRE(storage.GetTask(task_0.id) == retried);
+        }
+
+        SUBCASE("exhausted task becomes dead letter")
+        {
+            REQUIRE(storage.Fail(task_0.id, policy, now + 1s) == backend::FailResult::DeadLettered);
+
+            auto dead     = task_0;
+            dead.attempts = 2;
+            REQUIRE(storage.GetDeadLetters() == std::vector{dead});
+            REQUIRE(storage.PromoteDelayed(now + 1h) == 0);
+            REQUIRE(storage.ExpireLeases(now + 1h) == 1);
+            REQUIRE(storage.Dequeue(10) == std::vector{task_1});
+
+            SUBCASE("redrive resets attempts")
+            {
+                REQUIRE(storage.Redrive(task_0.id));
+                REQUIRE(!storage.Redrive(task_0.id));
+                REQUIRE(storage.GetDeadLetters().empty());
+                REQUIRE(storage.Dequeue(10) == std::vector{task_0});
+            }
+
+            SUBCASE("deleted dead letter is forgotten")
+            {
+                storage.DeleteTask(task_0.id);
+                REQUIRE(storage.GetDeadLetters().empty());
+                REQUIRE(!storage.Redrive(task_0.id));
+            }
+        }
+
+        SUBCASE("unknown task is not leased")
+        {
+            REQUIRE(storage.Fail(1000, policy, now) == backend::FailResult::NotLeased);
+            REQUIRE(!storage.Redrive(1000));
+        }
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage dequeues higher priority first")
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const auto low_0  = storage.CreateTask(backend::TaskPayload{.name = "low0"});
+        const auto high_0 = storage.CreateTask(backend::TaskPayload{.name = "high0", .priority = 200});
+        const auto low_1  = storage.CreateTask(backend::TaskPayload{.name = "low1"});
+        const auto high_1 = storage.CreateTask(backend::TaskPayload{.name = "high1", .priority = 200});
+        const auto middle = storage.CreateTask(backend::TaskPayload{.name = "middle", .priority = 100});
+
+        SUBCASE("dequeue")
+        {
+            REQUIRE(storage.Dequeue(2) == std::vector{high_0, high_1});
+            REQUIRE(storage.Dequeue(10) == std::vector{middle, low_0, low_1});
+        }
+
+        SUBCASE("batch keeps priorities")
+        {
+            const auto batch = storage.CreateTasks(std::vector{backend::TaskPayload{.name = "low2"}, backend::TaskPayload{.name = "highest", .priority = 255}});
+            REQUIRE(batch.size() == 2);
+            REQUIRE(storage.Dequeue(1) == std::vector{batch[1]});
+        }
+
+        SUBCASE("returned task keeps its priority")
+        {
+            const auto now = backend::Clock::now();
+            REQUIRE(storage.Claim(1, now + 10s) == std::vector{high_0});
+            REQUIRE(storage.Nack(high_0.id));
+            REQUIRE(storage.Claim(1, now + 10s) == std::vector{high_1});
+            REQUIRE(storage.ExpireLeases(now + 10s) == 1);
+            REQUIRE(storage.Dequeue(3) == std::vector{high_0, high_1, middle});
+        }
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>()});
+    }
+}
+
+TEST_CASE("every storage holds delayed tasks till their run time")
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto test = [](backend::DataStorage&& storage) // NOLINT
+    {
+        const auto now     = backend::Clock::now();
+        const auto ready   = storage.CreateTask(backend::TaskPayload{.name = "ready"});
+        const auto later   = storage.CreateTask(backend::TaskPayload{.name = "later", .run_at = backend::ToUnixMilliseconds(now + 2h)});
+        const auto soon    = storage.CreateTask(backend::TaskPayload{.name = "soon", .priority = 10, .run_at = backend::ToUnixMilliseconds(now + 1h)});
+        const auto overdue = storage.CreateTask(backend::TaskPayload{.name = "overdue", .run_at = backend::ToUnixMilliseconds(now - 1h)});
+
+        REQUIRE(storage.GetTask(later.id) == later);
+        REQUIRE(storage.GetTasks().size() == 4);
+        REQUIRE(storage.PromoteDelayed(now) == 0);
+        REQUIRE(storage.Dequeue(10) == std::vector{ready, overdue});
+
+        SUBCASE("promotion")
+        {
+            REQUIRE(storage.PromoteDelayed(now + 1h) == 1);
+            REQUIRE(storage.Dequeue(10) == std::vector{soon});
+            REQUIRE(storage.PromoteDelayed(now + 3h) == 1);
+            REQUIRE(storage.Dequeue(10) == std::vector{later});
+        }
+
+        SUBCASE("deleted delayed task is never promoted")
+        {
+            storage.DeleteTask(soon.id);
+            REQUIRE(storage.PromoteDelayed(now + 3h) == 1);
+            REQUIRE(storage.Dequeue(10) == std::vector{later});
+        }
+
+        SUBCASE("delayed tasks don't take queue capacity and wait for it when it is full")
+        {
+            for (size_t i = 0; i < 2; ++i)
+                storage.CreateTask(backend::TaskPayload{});
+
+            REQUIRE(storage.PromoteDelayed(now + 3h) == 0);
+            REQUIRE(storage.Dequeue(1).size() == 1);
+            REQUIRE(storage.PromoteDelayed(now + 3h + 1ms) == 1);
+            REQUIRE(storage.PromoteDelayed(now + 3h + 2ms) == 0);
+            REQUIRE(storage.Dequeue(10).size() == 2);
+            REQUIRE(storage.PromoteDelayed(now + 3h + 3ms) == 1);
+            REQUIRE(storage.Dequeue(10).size() == 1);
+            REQUIRE(storage.GetTasks().empty());
+        }
+    };
+
+    SUBCASE("InMemoryStorage")
+    {
+        test(backend::data_storage::InMemoryStorage{2});
+    }
+
+    SUBCASE("ShardedStorage")
+    {
+        test(backend::data_storage::ShardedStorage{4, 2});
+    }
+
+    SUBCASE("WalStorage")
+    {
+        test(backend::data_storage::WalStorage{std::make_unique<backend::data_storage::ShardedStorage>(4, 2), MakeWalConfig()});
+    }
+
+    SUBCASE("CombiningStorage")
+    {
+        test(backend::data_storage::CombiningStorage{std::make_unique<backend::data_storage::InMemoryStorage>(2)});
+    }
 }
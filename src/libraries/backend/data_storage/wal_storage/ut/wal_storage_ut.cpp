@@ -0,0 +1,402 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/data_storage/wal_storage/wal_storage.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    std::filesystem::path MakeLogDirectory()
+    {
+        const auto path = std::filesystem::temp_directory_path() / "wal_storage_ut";
+        std::filesystem::remove_all(path);
+        return path;
+    }
+
+    std::unique_ptr<backend::data_storage::WalStorage> Open(const std::filesystem::path& directory)
+    {
+        return std::make_unique<backend::data_storage::WalStorage>(std::make_unique<backend::data_storage::InMemoryStorage>(), backend::data_storage::WalStorage::Config{.directory = directory});
+    }
+
+    // Previous instance is closed first, as a restart would do
+    void Reopen(std::unique_ptr<backend::data_storage::WalStorage>& storage, const std::filesystem::path& directory)
+    {
+        storage.reset();
+        storage = Open(directory);
+    }
+
+    std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& directory, std::string_view extension)
+    {
+        std::vector<std::filesystem::path> result{};
+        for (const auto& entry : std::filesystem::directory_iterator{directory})
+            if (entry.path().extension() == extension)
+                result.push_back(entry.path());
+        std::ranges::sort(result);
+        return result;
+    }
+} // namespace
+
+TEST_CASE("WalStorage recovers tasks after restart")
+{
+    const auto directory = MakeLogDirectory();
+    auto       storage   = Open(directory);
+
+    const auto task_0 = storage->CreateTask(backend::TaskPayload{.name = "name0", .description = "description0"});
+    const auto task_1 = storage->CreateTask(backend::TaskPayload{.name = "name1"});
+    const auto task_2 = storage->CreateTask(backend::TaskPayload{.name = "name2"});
+    const auto task_3 = storage->CreateTask(backend::TaskPayload{.name = "name3"});
+
+    SUBCASE("created tasks")
+    {
+        Reopen(storage, directory);
+        REQUIRE(storage->GetTasks() == std::vector{task_0, task_1, task_2, task_3});
+        REQUIRE(storage->Dequeue(10) == std::vector{task_0, task_1, task_2, task_3});
+    }
+
+    SUBCASE("removed tasks are not recovered")
+    {
+        storage->DeleteTask(task_1.id);
+        REQUIRE(storage->Dequeue(1) == std::vector{task_0});
+        REQUIRE(storage->Claim(2, backend::Clock::now() + std::chrono::hours{1}) == std::vector{task_2, task_3});
+        REQUIRE(storage->Ack(task_2.id));
+
+        Reopen(storage, directory);
+        REQUIRE(storage->GetTasks() == std::vector{task_3});
+
+        SUBCASE("lease is not recovered")
+        {
+            REQUIRE(!storage->Ack(task_3.id));
+            REQUIRE(storage->Dequeue(10) == std::vector{task_3});
+        }
+    }
+
+    SUBCASE("ids are not reused")
+    {
+        REQUIRE(storage->Dequeue(10).size() == 4);
+
+        Reopen(storage, directory);
+        REQUIRE(storage->GetTasks().empty());
+        REQUIRE(storage->CreateTask(backend::TaskPayload{}).id == 4);
+    }
+
+    SUBCASE("torn tail is cut off")
+    {
+        storage.reset();
+        const auto segment = ListFiles(directory, ".wal").back();
+        std::filesystem::resize_file(segment, std::filesystem::file_size(segment) - 1);
+
+        storage = Open(directory);
+        REQUIRE(storage->GetTasks() == std::vector{task_0, task_1, task_2});
+        REQUIRE(storage->CreateTask(backend::TaskPayload{.name = "name4"}).id == 3);
+
+        Reopen(storage, directory);
+        REQUIRE(storage->GetTasks().size() == 4);
+    }
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage recovers priorities")
+{
+    const auto directory = MakeLogDirectory();
+    auto       storage   = Open(directory);
+
+    const auto low  = storage->CreateTask(backend::TaskPayload{.name = "low"});
+    const auto high = storage->CreateTask(backend::TaskPayload{.name = "high", .priority = 10});
+
+    SUBCASE("from log")
+    {
+        Reopen(storage, directory);
+    }
+
+    SUBCASE("from snapshot")
+    {
+        storage->Snapshot();
+        Reopen(storage, directory);
+    }
+
+    REQUIRE(storage->Dequeue(10) == std::vector{high, low});
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage recovers delayed tasks")
+{
+    const auto directory = MakeLogDirectory();
+    auto       storage   = Open(directory);
+
+    const auto run_at  = backend::Clock::now() + std::chrono::hours{1};
+    const auto delayed = storage->CreateTask(backend::TaskPayload{.name = "delayed", .run_at = backend::ToUnixMilliseconds(run_at)});
+    const auto ready   = storage->CreateTask(backend::TaskPayload{.name = "ready"});
+
+    SUBCASE("from log")
+    {
+        Reopen(storage, directory);
+    }
+
+    SUBCASE("from snapshot")
+    {
+        storage->Snapshot();
+        Reopen(storage, directory);
+    }
+
+    REQUIRE(storage->GetTask(delayed.id) == delayed);
+    REQUIRE(storage->Dequeue(10) == std::vector{ready});
+    REQUIRE(storage->PromoteDelayed(run_at) == 1);
+    REQUIRE(storage->Dequeue(10) == std::vector{delayed});
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage recovers attempts and dead letters")
+{
+    const auto directory = MakeLogDirectory();
+    auto       storage   = Open(directory);
+
+    bool snapshot_between{};
+    bool snapshot_after{};
+    SUBCASE("from log") {}
+    SUBCASE("from snapshot")
+    {
+        snapshot_after = true;
+    }
+    SUBCASE("from snapshot and log after it")
+    {
+        snapshot_between = true;
+    }
+
+    const auto policy   = backend::RetryPolicy{.max_attempts = 2, .backoff = backend::Clock::duration::zero()};
+    const auto deadline = backend::Clock::now() + std::chrono::hours{1};
+    auto       retried  = storage->CreateTask(backend::TaskPayload{.name = "retried"});
+    auto       dead     = storage->CreateTask(backend::TaskPayload{.name = "dead"});
+    auto       redriven = storage->CreateTask(backend::TaskPayload{.name = "redriven"});
+
+    REQUIRE(storage->Claim(3, deadline).size() == 3);
+    for (const auto& task : {retried, dead, redriven})
+        REQUIRE(storage->Fail(task.id, policy, backend::Clock::now()) == backend::FailResult::Retried);
+    if (snapshot_between)
+        storage->Snapshot();
+
+    REQUIRE(storage->Claim(3, deadline).size() == 3);
+    REQUIRE(storage->Nack(retried.id));
+    REQUIRE(storage->Fail(dead.id, policy, backend::Clock::now()) == backend::FailResult::DeadLettered);
+    REQUIRE(storage->Fail(redriven.id, policy, backend::Clock::now()) == backend::FailResult::DeadLettered);
+    REQUIRE(storage->Redrive(redriven.id));
+    if (snapshot_after)
+        storage->Snapshot();
+
+    Reopen(storage, directory);
+    retried.attempts = 1;
+    dead.attempts    = 2;
+    REQUIRE(storage->GetDeadLetters() == std::vector{dead});
+    REQUIRE(storage->Dequeue(10) == std::vector{retried, redriven});
+    REQUIRE(storage->GetTasks() == std::vector{dead});
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage reads snapshots of previous versions")
+{
+    const auto directory = MakeLogDirectory();
+    std::filesystem::create_directories(directory);
+    {
+        // Third version has no attempts and dead letters
+        std::string snapshot{"JQISNAP3"};
+        const auto  put = [&snapshot](auto value) { snapshot.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        put(uint64_t{1});
+        put(uint64_t{5});
+        put(uint64_t{3});
+        put(uint64_t{4});
+        snapshot.append("name");
+        put(uint64_t{0});
+        put(uint8_t{7});
+        put(uint64_t{0});
+        std::ofstream{directory / "snapshot-00000000000000000001.snap", std::ios::binary} << snapshot;
+    }
+
+    auto storage = Open(directory);
+    REQUIRE(storage->GetTasks() == std::vector{backend::Task{.id = 3, .payload = backend::TaskPayload{.name = "name", .priority = 7}}});
+    REQUIRE(storage->GetDeadLetters().empty());
+    REQUIRE(storage->CreateTask(backend::TaskPayload{}).id == 5);
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage snapshot truncates the log")
+{
+    const auto directory = MakeLogDirectory();
+    auto       storage   = Open(directory);
+
+    std::vector<backend::Task> tasks{};
+    for (size_t i = 0; i < 4; ++i)
+        tasks.push_back(storage->CreateTask(backend::TaskPayload{.name = "name" + std::to_string(i)}));
+    REQUIRE(storage->Dequeue(3).size() == 3);
+
+    storage->Snapshot();
+    REQUIRE(ListFiles(directory, ".snap").size() == 1);
+    REQUIRE(ListFiles(directory, ".wal").size() == 1);
+    REQUIRE(std::filesystem::file_size(ListFiles(directory, ".wal").front()) == 0);
+
+    SUBCASE("restart loads snapshot and log after it")
+    {
+        const auto task_4 = storage->CreateTask(backend::TaskPayload{.name = "name4"});
+        storage->DeleteTask(tasks[3].id);
+
+        Reopen(storage, directory);
+        REQUIRE(storage->GetTasks() == std::vector{task_4});
+        REQUIRE(storage->CreateTask(backend::TaskPayload{}).id == 5);
+
+        SUBCASE("next snapshot replaces previous one")
+        {
+            const auto previous = ListFiles(directory, ".snap");
+            storage->Snapshot();
+            REQUIRE(ListFiles(directory, ".snap").size() == 1);
+            REQUIRE(ListFiles(directory, ".snap") != previous);
+            REQUIRE(ListFiles(directory, ".wal").size() == 1);
+
+            Reopen(storage, directory);
+            REQUIRE(storage->GetTasks().size() == 2);
+        }
+    }
+
+    SUBCASE("unchanged log is not snapshotted again")
+    {
+        const auto files = ListFiles(directory, ".snap");
+        storage->Snapshot();
+        REQUIRE(ListFiles(directory, ".snap") == files);
+    }
+
+    SUBCASE("ids are not reused")
+    {
+        REQUIRE(storage->Dequeue(1).size() == 1);
+        storage->Snapshot();
+
+        Reopen(storage, directory);
+        REQUIRE(storage->GetTasks().empty());
+        REQUIRE(storage->CreateTask(backend::TaskPayload{}).id == 4);
+    }
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage snapshot doesn't block concurrent mutations")
+{
+    constexpr size_t threads_count    = 4;
+    constexpr size_t tasks_per_thread = 500;
+
+    const auto directory = MakeLogDirectory();
+    auto       storage   = Open(directory);
+
+    std::atomic_bool          stop{};
+    std::vector<std::jthread> threads{};
+    for (size_t i = 0; i < threads_count; ++i)
+    {
+        threads.emplace_back([&storage] {
+            const auto policy = backend::RetryPolicy{.max_attempts = 1};
+            for (size_t j = 0; j < tasks_per_thread; ++j)
+            {
+                const auto task = storage->CreateTask(backend::TaskPayload{.name = "name" + std::to_string(j)});
+                if (j % 3 == 0)
+                    storage->DeleteTask(task.id);
+                else if (j % 3 == 1)
+                    for (const auto& claimed : storage->Claim(1, backend::Clock::now() + std::chrono::hours{1}))
+                        storage->Fail(claimed.id, policy, backend::Clock::now());
+            }
+        });
+    }
+    std::jthread snapshotter{[&] {
+        while (!stop)
+            storage->Snapshot();
+    }};
+    threads.clear();
+    stop = true;
+    snapshotter.join();
+
+    const auto tasks        = storage->GetTasks();
+    const auto dead_letters = storage->GetDeadLetters();
+    REQUIRE(!dead_letters.empty());
+
+    Reopen(storage, directory);
+    REQUIRE(storage->GetTasks() == tasks);
+    REQUIRE(storage->GetDeadLetters() == dead_letters);
+    REQUIRE(storage->CreateTask(backend::TaskPayload{}).id == threads_count * tasks_per_thread);
+
+    storage.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage snapshots periodically")
+{
+    const auto directory = MakeLogDirectory();
+    {
+        backend::data_storage::WalStorage storage{std::make_unique<backend::data_storage::InMemoryStorage>(),
+                                                  backend::data_storage::WalStorage::Config{.directory = directory, .snapshot_interval = std::chrono::seconds{1}}};
+        storage.CreateTask(backend::TaskPayload{.name = "name"});
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+        while (ListFiles(directory, ".snap").empty() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        REQUIRE(ListFiles(directory, ".snap").size() == 1);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("WalStorage coalesces concurrent writes")
+{
+    constexpr size_t threads_count    = 8;
+    constexpr size_t tasks_per_thread = 500;
+
+    const auto directory = MakeLogDirectory();
+    {
+        backend::data_storage::WalStorage storage{std::make_unique<backend::data_storage::InMemoryStorage>(),
+                                                  backend::data_storage::WalStorage::Config{.directory = directory, .flush_interval = std::chrono::microseconds{100}, .max_batch_size = 4}};
+
+        std::vector<std::thread> threads{};
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&storage] {
+                for (size_t j = 0; j < tasks_per_thread; ++j)
+                    storage.CreateTask(backend::TaskPayload{.name = "name"});
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+
+    const auto storage = Open(directory);
+    const auto tasks   = storage->GetTasks();
+    REQUIRE(tasks.size() == threads_count * tasks_per_thread);
+    for (size_t i = 0; i < tasks.size(); ++i)
+        REQUIRE(tasks[i].id == i);
+
+    std::filesystem::remove_all(directory);
+}
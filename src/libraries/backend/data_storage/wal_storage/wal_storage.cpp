@@ -0,0 +1,277 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "wal_storage.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+namespace backend::data_storage
+{
+    WalStorage::WalStorage(std::unique_ptr<DataStorage> storage, const Config& config)
+        : m_storage{std::move(storage)}
+        , m_log{WriteAheadLog::Config{.directory = config.directory, .flush_interval = config.flush_interval, .max_batch_size = config.max_batch_size}}
+    {
+        if (!m_storage)
+            throw std::invalid_argument("Storage cannot be null");
+
+        auto recovered = m_log.TakeRecovered();
+        m_next_id      = recovered.next_id;
+        m_storage->Restore(std::move(recovered.tasks), std::move(recovered.dead_letters), recovered.next_id);
+
+        if (config.snapshot_interval.count() > 0)
+            m_snapshotter = std::thread{[this, interval = config.snapshot_interval] { RunSnapshots(interval); }};
+    }
+
+    WalStorage::~WalStorage()
+    {
+        {
+            std::lock_guard _{m_stop_mutex};
+            m_stopping = true;
+        }
+        m_stop_cv.notify_one();
+        if (m_snapshotter.joinable())
+            m_snapshotter.join();
+    }
+
+    Task WalStorage::CreateTask(const TaskPayload& payload)
+    {
+        std::unique_lock lock{m_mutex};
+        auto             task     = m_storage->CreateTask(payload);
+        const auto       sequence = m_log.LogCreate({&task, 1});
+        m_next_id                 = std::max(m_next_id, task.id + 1);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+        return task;
+    }
+
+    void WalStorage::DeleteTask(size_t index)
+    {
+        std::unique_lock lock{m_mutex};
+        m_storage->DeleteTask(index);
+        const auto sequence = m_log.LogDelete({&index, 1});
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+    }
+
+    std::optional<Task> WalStorage::GetTask(size_t index) const
+    {
+        return m_storage->GetTask(index);
+    }
+
+    std::vector<Task> WalStorage::GetTasks() const
+    {
+        return m_storage->GetTasks();
+    }
+
+    std::vector<Task> WalStorage::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        return m_storage->GetTasks(after, limit);
+    }
+
+    std::vector<Task> WalStorage::CreateTasks(std::span<const TaskPayload> payloads)
+    {
+        std::unique_lock lock{m_mutex};
+        auto             tasks = m_storage->CreateTasks(payloads);
+        if (tasks.empty())
+            return tasks;
+
+        // Whole batch is a single log record, so it is flushed and awaited once
+        const auto sequence = m_log.LogCreate(tasks);
+        m_next_id           = std::max(m_next_id, tasks.back().id + 1);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+        return tasks;
+    }
+
+    std::vector<Task> WalStorage::GetTasks(std::span<const size_t> ids) const
+    {
+        return m_storage->GetTasks(ids);
+    }
+
+    void WalStorage::DeleteTasks(std::span<const size_t> ids)
+    {
+        if (ids.empty())
+            return;
+
+        std::unique_lock lock{m_mutex};
+        m_storage->DeleteTasks(ids);
+        const auto sequence = m_log.LogDelete(ids);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+    }
+
+    std::vector<Task> WalStorage::Dequeue(size_t count)
+    {
+        std::unique_lock lock{m_mutex};
+        auto             tasks = m_storage->Dequeue(count);
+        if (tasks.empty())
+            return tasks;
+
+        std::vector<size_t> ids{};
+        ids.reserve(tasks.size());
+        for (const auto& task : tasks)
+            ids.push_back(task.id);
+        const auto sequence = m_log.LogDelete(ids);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+        return tasks;
+    }
+
+    std::vector<Task> WalStorage::Claim(size_t count, Clock::time_point deadline)
+    {
+        return m_storage->Claim(count, deadline);
+    }
+
+    bool WalStorage::Ack(size_t index)
+    {
+        std::unique_lock lock{m_mutex};
+        if (!m_storage->Ack(index))
+            return false;
+
+        const auto sequence = m_log.LogDelete({&index, 1});
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+        return true;
+    }
+
+    bool WalStorage::Nack(size_t index)
+    {
+        return m_storage->Nack(index);
+    }
+
+    FailResult WalStorage::Fail(size_t index, const RetryPolicy& policy, Clock::time_point now)
+    {
+        std::unique_lock lock{m_mutex};
+        const auto       result = m_storage->Fail(index, policy, now);
+        if (result == FailResult::NotLeased)
+            return result;
+
+        // Task can't be deleted in between, deletes are serialized by the same lock
+        const auto task     = m_storage->GetTask(index).value();
+        const auto sequence = m_log.LogAttempts({&task, 1}, result == FailResult::DeadLettered);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+        return result;
+    }
+
+    std::vector<Task> WalStorage::GetDeadLetters() const
+    {
+        return m_storage->GetDeadLetters();
+    }
+
+    bool WalStorage::Redrive(size_t index)
+    {
+        std::unique_lock lock{m_mutex};
+        if (!m_storage->Redrive(index))
+            return false;
+
+        const auto task     = m_storage->GetTask(index).value();
+        const auto sequence = m_log.LogAttempts({&task, 1}, false);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+        return true;
+    }
+
+    bool WalStorage::ExtendLease(size_t index, Clock::time_point deadline)
+    {
+        return m_storage->ExtendLease(index, deadline);
+    }
+
+    size_t WalStorage::ExpireLeases(Clock::time_point now)
+    {
+        return m_storage->ExpireLeases(now);
+    }
+
+    size_t WalStorage::PromoteDelayed(Clock::time_point now)
+    {
+        return m_storage->PromoteDelayed(now);
+    }
+
+    void WalStorage::Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id)
+    {
+        std::vector<Task> retried{};
+        std::ranges::copy_if(tasks, std::back_inserter(retried), [](const Task& task) { return task.attempts != 0; });
+
+        std::unique_lock lock{m_mutex};
+        m_storage->Restore(tasks, dead_letters, next_id);
+        m_next_id = std::max(m_next_id, next_id);
+        m_log.LogNextId(next_id);
+        m_log.LogCreate(tasks);
+        m_log.LogCreate(dead_letters);
+        m_log.LogAttempts(retried, false);
+        const auto sequence = m_log.LogAttempts(dead_letters, true);
+        lock.unlock();
+
+        m_log.WaitDurable(sequence);
+    }
+
+    void WalStorage::Snapshot()
+    {
+        std::lock_guard snapshot_lock{m_snapshot_mutex};
+
+        size_t   next_id{};
+        uint64_t segment{};
+        {
+            std::lock_guard _{m_mutex};
+            const auto      rotated = m_log.Rotate();
+            if (!rotated)
+                return;
+
+            segment = rotated.value();
+            next_id = m_next_id;
+        }
+
+        // Mutations made since rotation could get into the snapshot, they are logged after it and replayed on top of it anyway.
+        // Task created since rotation could be snapshotted before its own record is durable, so next id covers it too
+        const auto          tasks = m_storage->GetTasks();
+        std::vector<size_t> dead_letters{};
+        for (const auto& task : m_storage->GetDeadLetters())
+            dead_letters.push_back(task.id);
+        for (const auto& task : tasks)
+            next_id = std::max(next_id, task.id + 1);
+        m_log.Snapshot(segment, tasks, dead_letters, next_id);
+    }
+
+    void WalStorage::RunSnapshots(std::chrono::seconds interval)
+    {
+        std::unique_lock lock{m_stop_mutex};
+        while (!m_stop_cv.wait_for(lock, interval, [this] { return m_stopping; }))
+        {
+            lock.unlock();
+            try
+            {
+                Snapshot();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Error in snapshot: " << e.what() << "\n";
+            }
+            lock.lock();
+        }
+    }
+} // namespace backend::data_storage
@@ -0,0 +1,97 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/data_storage/interface/data_storage.hpp>
+#include <libraries/backend/data_storage/wal_storage/write_ahead_log.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Durable storage: decorates in-memory storage with write-ahead log of created and removed tasks.
+     * @details Mutation is applied to the underlying storage and appended to the log under one lock, call returns once the log is durable.
+     * So log order matches apply order. Snapshot is read after the log is rotated, so it holds the state of the log before rotation plus some of the later
+     * mutations: replay of the log after rotation applies them again, and every record sets the state rather than changes it, so the result is the same.
+     * Leases are not logged: tasks claimed but not acked before restart return to the queue.
+     * Attempts of failed tasks and dead letters are logged, backoffs are not: task waiting for retry before restart is queued at once.
+     */
+    class WalStorage final : public DataStorage
+    {
+    public:
+        struct Config
+        {
+            std::filesystem::path     directory{};
+            std::chrono::microseconds flush_interval{};      // See WriteAheadLog::Config
+            size_t                    max_batch_size = 4096; // See WriteAheadLog::Config
+            std::chrono::seconds      snapshot_interval{};   // Period of background snapshots, zero disables them
+        };
+
+        /**
+         * @param storage empty storage, it is filled with tasks recovered from the log
+         */
+        WalStorage(std::unique_ptr<DataStorage> storage, const Config& config);
+        ~WalStorage() override;
+
+        Task                CreateTask(const TaskPayload& payload) override;
+        void                DeleteTask(size_t index) override;
+        std::optional<Task> GetTask(size_t index) const override;
+        std::vector<Task>   GetTasks() const override;
+        std::vector<Task>   GetTasks(std::optional<size_t> after, size_t limit) const override;
+        std::vector<Task>   CreateTasks(std::span<const TaskPayload> payloads) override;
+        std::vector<Task>   GetTasks(std::span<const size_t> ids) const override;
+        void                DeleteTasks(std::span<const size_t> ids) override;
+        std::vector<Task>   Dequeue(size_t count) override;
+        std::vector<Task>   Claim(size_t count, Clock::time_point deadline) override;
+        bool                Ack(size_t index) override;
+        bool                Nack(size_t index) override;
+        FailResult          Fail(size_t index, const RetryPolicy& policy, Clock::time_point now) override;
+        std::vector<Task>   GetDeadLetters() const override;
+        bool                Redrive(size_t index) override;
+        bool                ExtendLease(size_t index, Clock::time_point deadline) override;
+        size_t              ExpireLeases(Clock::time_point now) override;
+        size_t              PromoteDelayed(Clock::time_point now) override;
+        void                Restore(std::vector<Task> tasks, std::vector<Task> dead_letters, size_t next_id) override;
+
+        /**
+         * @brief Writes snapshot of alive tasks and truncates the log it covers, so the next start replays only the log written after it
+         * @details Mutations are paused only while the log is rotated, tasks are read and snapshot file is written without blocking them
+         */
+        void Snapshot();
+
+    private:
+        void RunSnapshots(std::chrono::seconds interval);
+
+    private:
+        std::unique_ptr<DataStorage> m_storage;
+        WriteAheadLog                m_log;
+        std::mutex                   m_mutex{};
+        size_t                       m_next_id{};
+
+        std::mutex              m_snapshot_mutex{};
+        std::mutex              m_stop_mutex{};
+        std::condition_variable m_stop_cv{};
+        bool                    m_stopping{};
+        std::thread             m_snapshotter{};
+    };
+} // namespace backend::data_storage
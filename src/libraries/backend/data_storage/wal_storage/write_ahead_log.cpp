@@ -0,0 +1,621 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "write_ahead_log.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace backend::data_storage
+{
+    namespace
+    {
+        enum class RecordType : uint8_t
+        {
+            Create = 1,
+            Delete   = 2,
+            NextId   = 3,
+            Attempts = 4,
+        };
+
+        // Latest attempts of failed task, they are logged on every fail and redrive
+        struct TaskState
+        {
+            uint32_t attempts{};
+            bool     dead{};
+        };
+
+        // Frame is `[u32 size][u32 checksum][payload]`, numbers are stored in native byte order
+        constexpr size_t frame_header_size = 2 * sizeof(uint32_t);
+
+        // Snapshot is `[magic][u64 count][u64 next id]` followed by `count` of `[u64 id][string name][string description][u8 priority][u64 run at][u32 attempts][u8 dead]`,
+        // string is `[u64 size][bytes]`. Last character of magic is the format version: snapshots of the first version have no priority, snapshots of the second one
+        // have no run time, snapshots of the third one have no attempts and dead letters
+        constexpr std::string_view snapshot_magic      = "JQISNAP4";
+        constexpr size_t           snapshot_chunk_size = size_t{1} << 20;
+
+        constexpr std::string_view segment_prefix  = "segment-";
+        constexpr std::string_view segment_suffix  = ".wal";
+        constexpr std::string_view snapshot_prefix = "snapshot-";
+        constexpr std::string_view snapshot_suffix = ".snap";
+        constexpr std::string_view tmp_suffix      = ".tmp";
+
+        uint32_t Checksum(std::string_view data)
+        {
+            // FNV-1a
+            uint32_t hash = 2166136261u;
+            for (const auto c : data)
+                hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+            return hash;
+        }
+
+        template<typename T>
+        void Put(std::string& out, T value)
+        {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void PutString(std::string& out, const std::string& value)
+        {
+            Put<uint64_t>(out, value.size());
+            out.append(value);
+        }
+
+        template<typename T>
+        bool Get(std::string_view& in, T& value)
+        {
+            if (in.size() < sizeof(value))
+                return false;
+            std::memcpy(&value, in.data(), sizeof(value));
+            in.remove_prefix(sizeof(value));
+            return true;
+        }
+
+        bool GetString(std::string_view& in, std::string& value)
+        {
+            uint64_t size{};
+            if (!Get(in, size) || in.size() < size)
+                return false;
+            value.assign(in.substr(0, size));
+            in.remove_prefix(size);
+            return true;
+        }
+
+        /**
+         * @brief Appends frame of the record, `put_body` appends fields following the id
+         */
+        template<typename PutBody>
+        void PutFrame(std::string& out, RecordType type, uint64_t id, PutBody&& put_body)
+        {
+            const auto start = out.size();
+            out.append(frame_header_size, '\0');
+            Put(out, type);
+            Put(out, id);
+            put_body(out);
+
+            const auto     frame    = std::string_view{out}.substr(start + frame_header_size);
+            const uint32_t size     = static_cast<uint32_t>(frame.size());
+            const uint32_t checksum = Checksum(frame);
+            std::memcpy(out.data() + start, &size, sizeof(size));
+            std::memcpy(out.data() + start + sizeof(size), &checksum, sizeof(checksum));
+        }
+
+        void PutFrame(std::string& out, RecordType type, uint64_t id)
+        {
+            PutFrame(out, type, id, [](std::string&) {});
+        }
+
+        std::system_error LastError(const std::string& what)
+        {
+            return std::system_error{errno, std::generic_category(), what};
+        }
+
+        std::error_code WriteAll(int fd, std::string_view data)
+        {
+            while (!data.empty())
+            {
+                const auto written = ::write(fd, data.data(), data.size());
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return {errno, std::generic_category()};
+                }
+                data.remove_prefix(static_cast<size_t>(written));
+            }
+            return {};
+        }
+
+        std::error_code Sync(int fd)
+        {
+#ifdef __linux__
+            const auto result = ::fdatasync(fd);
+#else
+            const auto result = ::fsync(fd);
+#endif
+            return result == 0 ? std::error_code{} : std::error_code{errno, std::generic_category()};
+        }
+
+        // Created, renamed and removed files are durable only once directory is synced
+        void SyncDirectory(const std::filesystem::path& directory)
+        {
+            if (const auto fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC); fd >= 0)
+            {
+                ::fsync(fd);
+                ::close(fd);
+            }
+        }
+
+        std::filesystem::path FileName(std::string_view prefix, uint64_t number, std::string_view suffix)
+        {
+            // Zero padded, so files are listed in order
+            auto number_str = std::to_string(number);
+            return std::string{prefix} + std::string(20 - number_str.size(), '0') + number_str + std::string{suffix};
+        }
+
+        std::optional<uint64_t> ParseFileName(std::string_view name, std::string_view prefix, std::string_view suffix)
+        {
+            if (!name.starts_with(prefix) || !name.ends_with(suffix))
+                return {};
+
+            name = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+
+            uint64_t   number{};
+            const auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), number);
+            if (ec != std::errc{} || ptr != name.data() + name.size())
+                return {};
+            return number;
+        }
+
+        /**
+         * @brief Removes segments and snapshots older than `segment`
+         */
+        void RemoveCovered(const std::filesystem::path& directory, uint64_t segment)
+        {
+            for (const auto& entry : std::filesystem::directory_iterator{directory})
+            {
+                const auto name   = entry.path().filename().string();
+                auto       number = ParseFileName(name, segment_prefix, segment_suffix);
+                if (!number)
+                    number = ParseFileName(name, snapshot_prefix, snapshot_suffix);
+                if (number && number.value() < segment)
+                    std::filesystem::remove(entry.path());
+            }
+        }
+
+        /**
+         * @brief Read-only memory mapping of the whole file
+         */
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::filesystem::path& path)
+            {
+                const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                    throw LastError("Failed to open " + path.string());
+
+                struct stat st{};
+                if (::fstat(fd, &st) != 0)
+                {
+                    ::close(fd);
+                    throw LastError("Failed to stat " + path.string());
+                }
+
+                m_size = static_cast<size_t>(st.st_size);
+                if (m_size != 0)
+                {
+                    m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (m_data == MAP_FAILED)
+                    {
+                        ::close(fd);
+                        throw LastError("Failed to map " + path.string());
+                    }
+                    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+                }
+                ::close(fd);
+            }
+
+            ~MappedFile()
+            {
+                if (m_size != 0)
+                    ::munmap(m_data, m_size);
+            }
+
+            MappedFile(const MappedFile&)            = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            std::string_view View() const { return m_size == 0 ? std::string_view{} : std::string_view{static_cast<const char*>(m_data), m_size}; }
+
+        private:
+            void*  m_data{};
+            size_t m_size{};
+        };
+
+        WriteAheadLog::Recovered LoadSnapshot(const std::filesystem::path& path)
+        {
+            const MappedFile file{path};
+            auto             in = file.View();
+
+            WriteAheadLog::Recovered result{};
+            uint64_t                 count{};
+            uint8_t                  dead{};
+            if (in.size() < snapshot_magic.size() || !in.starts_with(snapshot_magic.substr(0, snapshot_magic.size() - 1)))
+                throw std::runtime_error("Invalid snapshot " + path.string());
+
+            const auto version = in[snapshot_magic.size() - 1];
+            if (version < '1' || version > snapshot_magic.back())
+                throw std::runtime_error("Invalid snapshot " + path.string());
+            in.remove_prefix(snapshot_magic.size());
+            // Every task takes at least three numbers
+            if (!Get(in, count) || !Get(in, result.next_id) || count > in.size() / (3 * sizeof(uint64_t)))
+                throw std::runtime_error("Invalid snapshot " + path.string());
+
+            result.tasks.reserve(count);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                Task     task{};
+                uint64_t id{};
+                if (!Get(in, id) || !GetString(in, task.payload.name) || !GetString(in, task.payload.description) || (version >= '2' && !Get(in, task.payload.priority)) || (version >= '3' && !Get(in, task.payload.run_at)) ||
+                    (version >= '4' && (!Get(in, task.attempts) || !Get(in, dead))))
+                    throw std::runtime_error("Invalid snapshot " + path.string());
+                task.id = id;
+                (dead != 0 ? result.dead_letters : result.tasks).push_back(std::move(task));
+            }
+            return result;
+        }
+
+        /**
+         * @brief Applies records of the segment till its end or torn tail
+         */
+        void ReplaySegment(const std::filesystem::path& path, std::map<size_t, TaskPayload>& created, std::unordered_set<size_t>& deleted, std::unordered_map<size_t, TaskState>& states, size_t& next_id)
+        {
+            const MappedFile file{path};
+            for (auto in = file.View();;)
+            {
+                uint32_t size{};
+                uint32_t checksum{};
+                if (!Get(in, size) || !Get(in, checksum) || in.size() < size || Checksum(in.substr(0, size)) != checksum)
+                    return;
+
+                auto frame = in.substr(0, size);
+                in.remove_prefix(size);
+
+                RecordType type{};
+                uint64_t   id{};
+                if (!Get(frame, type) || !Get(frame, id))
+                    return;
+
+                switch (type)
+                {
+                case RecordType::Create:
+                {
+                    TaskPayload payload{};
+                    if (!GetString(frame, payload.name) || !GetString(frame, payload.description))
+                        return;
+                    // Records written before priorities and run times were introduced end right after description or priority
+                    if (Get(frame, payload.priority))
+                        Get(frame, payload.run_at);
+                    next_id = std::max<size_t>(next_id, id + 1);
+                    created.insert_or_assign(id, std::move(payload));
+                    break;
+                }
+                case RecordType::Delete: deleted.insert(id); break;
+                case RecordType::NextId: next_id = std::max<size_t>(next_id, id); break;
+                case RecordType::Attempts:
+                {
+                    TaskState state{};
+                    uint8_t   dead{};
+                    if (!Get(frame, state.attempts) || !Get(frame, dead))
+                        return;
+                    state.dead = dead != 0;
+                    states.insert_or_assign(id, state);
+                    break;
+                }
+                }
+            }
+        }
+    } // namespace
+
+    WriteAheadLog::WriteAheadLog(Config config)
+        : m_config{std::move(config)}
+    {
+        Recover();
+        m_flusher = std::thread{[this] { Run(); }};
+    }
+
+    WriteAheadLog::~WriteAheadLog()
+    {
+        {
+            std::lock_guard _{m_mutex};
+            m_stopping = true;
+        }
+        m_flush_cv.notify_one();
+        m_flusher.join();
+        ::close(m_fd);
+    }
+
+    WriteAheadLog::Recovered WriteAheadLog::TakeRecovered()
+    {
+        return std::exchange(m_recovered, {});
+    }
+
+    uint64_t WriteAheadLog::LogCreate(std::span<const Task> tasks)
+    {
+        std::string frames{};
+        for (const auto& task : tasks)
+        {
+            PutFrame(frames, RecordType::Create, task.id, [&payload = task.payload](std::string& out) {
+                PutString(out, payload.name);
+                PutString(out, payload.description);
+                Put(out, payload.priority);
+                Put(out, payload.run_at);
+            });
+        }
+        return Append(std::move(frames), tasks.size());
+    }
+
+    uint64_t WriteAheadLog::LogDelete(std::span<const size_t> ids)
+    {
+        std::string frames{};
+        for (const auto id : ids)
+            PutFrame(frames, RecordType::Delete, id);
+        return Append(std::move(frames), ids.size());
+    }
+
+    uint64_t WriteAheadLog::LogAttempts(std::span<const Task> tasks, bool dead)
+    {
+        std::string frames{};
+        for (const auto& task : tasks)
+        {
+            PutFrame(frames, RecordType::Attempts, task.id, [&](std::string& out) {
+                Put(out, task.attempts);
+                Put<uint8_t>(out, dead);
+            });
+        }
+        return Append(std::move(frames), tasks.size());
+    }
+
+    uint64_t WriteAheadLog::LogNextId(size_t next_id)
+    {
+        std::string frames{};
+        PutFrame(frames, RecordType::NextId, next_id);
+        return Append(std::move(frames), 1);
+    }
+
+    void WriteAheadLog::WaitDurable(uint64_t sequence)
+    {
+        std::unique_lock lock{m_mutex};
+        m_durable_cv.wait(lock, [&] { return m_durable >= sequence || m_error; });
+        if (m_durable < sequence)
+            throw std::system_error{m_error, "Write-ahead log failed"};
+    }
+
+    std::optional<uint64_t> WriteAheadLog::Rotate()
+    {
+        std::unique_lock lock{m_mutex};
+        if (m_first_segment == m_segment && m_segment_records == 0)
+            return {};
+
+        m_durable_cv.wait(lock, [&] { return m_durable == m_appended || m_error; });
+        if (m_error)
+            throw std::system_error{m_error, "Write-ahead log failed"};
+
+        OpenSegment(m_segment + 1);
+        return m_segment;
+    }
+
+    void WriteAheadLog::Snapshot(uint64_t segment, std::span<const Task> tasks, std::span<const size_t> dead_letters, size_t next_id)
+    {
+        const auto path     = m_config.directory / FileName(snapshot_prefix, segment, snapshot_suffix);
+        const auto tmp_path = std::filesystem::path{path}.concat(tmp_suffix);
+        const auto fd       = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw LastError("Failed to open " + tmp_path.string());
+
+        std::string buffer{snapshot_magic};
+        Put<uint64_t>(buffer, tasks.size());
+        Put<uint64_t>(buffer, next_id);
+
+        std::error_code error{};
+        for (const auto& task : tasks)
+        {
+            Put<uint64_t>(buffer, task.id);
+            PutString(buffer, task.payload.name);
+            PutString(buffer, task.payload.description);
+            Put(buffer, task.payload.priority);
+            Put(buffer, task.payload.run_at);
+            Put(buffer, task.attempts);
+            Put<uint8_t>(buffer, std::ranges::binary_search(dead_letters, task.id));
+            if (buffer.size() < snapshot_chunk_size)
+                continue;
+
+            error = WriteAll(fd, buffer);
+            if (error)
+                break;
+            buffer.clear();
+        }
+        if (!error)
+            error = WriteAll(fd, buffer);
+        if (!error)
+            error = Sync(fd);
+        ::close(fd);
+        if (error)
+            throw std::system_error{error, "Failed to write " + tmp_path.string()};
+
+        // Snapshot is complete once renamed, so crash at any point leaves either old or new snapshot together with segments it doesn't cover
+        std::filesystem::rename(tmp_path, path);
+        SyncDirectory(m_config.directory);
+
+        RemoveCovered(m_config.directory, segment);
+
+        std::lock_guard _{m_mutex};
+        m_first_segment = std::max(m_first_segment, segment);
+    }
+
+    void WriteAheadLog::Recover()
+    {
+        std::filesystem::create_directories(m_config.directory);
+
+        std::optional<uint64_t> snapshot{};
+        std::vector<uint64_t>   segments{};
+        for (const auto& entry : std::filesystem::directory_iterator{m_config.directory})
+        {
+            const auto name = entry.path().filename().string();
+            if (const auto snapshot_number = ParseFileName(name, snapshot_prefix, snapshot_suffix))
+                snapshot = std::max(snapshot.value_or(0), snapshot_number.value());
+            else if (const auto segment_number = ParseFileName(name, segment_prefix, segment_suffix))
+                segments.push_back(segment_number.value());
+            else if (name.ends_with(tmp_suffix))
+                std::filesystem::remove(entry.path()); // Snapshot interrupted by crash
+        }
+        std::ranges::sort(segments);
+
+        m_first_segment = snapshot.value_or(0);
+        if (snapshot)
+        {
+            // Segments and snapshots could be left by snapshot interrupted before truncation
+            RemoveCovered(m_config.directory, m_first_segment);
+            m_recovered = LoadSnapshot(m_config.directory / FileName(snapshot_prefix, snapshot.value(), snapshot_suffix));
+        }
+
+        // Delete can be logged before create of the same task, ids are never reused, so order doesn't matter.
+        // Attempts of the same task are logged in order, so the latest ones win, and they override state of snapshotted dead letters
+        std::map<size_t, TaskPayload>         created{};
+        std::unordered_set<size_t>            deleted{};
+        std::unordered_map<size_t, TaskState> states{};
+        for (const auto& task : m_recovered.dead_letters)
+            states.emplace(task.id, TaskState{.attempts = task.attempts, .dead = true});
+        for (const auto segment : segments)
+        {
+            if (segment >= m_first_segment)
+                ReplaySegment(m_config.directory / FileName(segment_prefix, segment, segment_suffix), created, deleted, states, m_recovered.next_id);
+        }
+
+        auto& tasks = m_recovered.tasks;
+        std::ranges::move(m_recovered.dead_letters, std::back_inserter(tasks));
+        m_recovered.dead_letters.clear();
+        if (!deleted.empty())
+            std::erase_if(tasks, [&deleted](const Task& task) { return deleted.contains(task.id); });
+        for (auto& [id, payload] : created)
+            if (!deleted.contains(id))
+                tasks.push_back(Task{.id = id, .payload = std::move(payload)});
+        if (!std::ranges::is_sorted(tasks, std::ranges::less{}, &Task::id))
+            std::ranges::sort(tasks, std::ranges::less{}, &Task::id);
+
+        if (!states.empty())
+        {
+            // Dead letters are split off the tasks, the rest keep their order
+            for (auto& task : tasks)
+            {
+                const auto state = states.find(task.id);
+                if (state == states.end())
+                    continue;
+
+                task.attempts = state->second.attempts;
+                if (state->second.dead)
+                    m_recovered.dead_letters.push_back(std::move(task));
+            }
+            std::erase_if(tasks, [&states](const Task& task) {
+                const auto state = states.find(task.id);
+                return state != states.end() && state->second.dead;
+            });
+        }
+
+        // Appends always go to the new segment, so torn tail of the previous one stays behind the valid records
+        OpenSegment(segments.empty() ? m_first_segment : std::max(m_first_segment, segments.back() + 1));
+        if (segments.empty() || segments.back() < m_first_segment)
+            m_first_segment = m_segment;
+    }
+
+    void WriteAheadLog::OpenSegment(uint64_t segment)
+    {
+        const auto path = m_config.directory / FileName(segment_prefix, segment, segment_suffix);
+        const auto fd   = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw LastError("Failed to open " + path.string());
+        SyncDirectory(m_config.directory);
+
+        if (m_fd >= 0)
+            ::close(m_fd);
+        m_fd              = fd;
+        m_segment         = segment;
+        m_segment_records = 0;
+    }
+
+    uint64_t WriteAheadLog::Append(std::string frames, size_t records)
+    {
+        std::lock_guard _{m_mutex};
+        if (m_error)
+            throw std::system_error{m_error, "Write-ahead log failed"};
+
+        m_pending.append(frames);
+        m_pending_records += records;
+        m_segment_records += records;
+        m_flush_cv.notify_one();
+        return ++m_appended;
+    }
+
+    void WriteAheadLog::Run()
+    {
+        std::string      batch{};
+        std::unique_lock lock{m_mutex};
+        while (true)
+        {
+            m_flush_cv.wait(lock, [&] { return m_stopping || !m_pending.empty(); });
+            if (m_pending.empty())
+                return;
+
+            if (m_config.flush_interval.count() > 0)
+                m_flush_cv.wait_for(lock, m_config.flush_interval, [&] { return m_stopping || m_pending_records >= m_config.max_batch_size; });
+
+            // Buffers are swapped to reuse their capacity
+            batch.clear();
+            std::swap(batch, m_pending);
+            m_pending_records   = 0;
+            const auto sequence = m_appended;
+            const auto fd       = m_fd;
+
+            lock.unlock();
+            auto error = WriteAll(fd, batch);
+            if (!error)
+                error = Sync(fd);
+            lock.lock();
+
+            if (error)
+            {
+                m_error = error;
+                m_durable_cv.notify_all();
+                return;
+            }
+            m_durable = sequence;
+            m_durable_cv.notify_all();
+        }
+    }
+} // namespace backend::data_storage
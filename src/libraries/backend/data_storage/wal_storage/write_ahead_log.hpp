@@ -0,0 +1,118 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/interface/task/task.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace backend::data_storage
+{
+    /**
+     * @brief Append-only durable log of created and deleted tasks and attempts of failed ones with group commit and snapshots.
+     * @details Log is a directory of numbered segments and snapshots: snapshot N holds alive tasks of all segments before N, so startup loads the latest snapshot and replays only segments after it.
+     * Concurrent appends are coalesced by the background flusher into batches: every batch is written by single `write` and made durable by single `fdatasync`.
+     * Records are framed with size and checksum, so torn tail left by a crash is cut off on open.
+     */
+    class WriteAheadLog
+    {
+    public:
+        struct Config
+        {
+            std::filesystem::path     directory{};
+            std::chrono::microseconds flush_interval{};      // How long flusher waits for more records before write, zero writes as soon as previous batch is durable
+            size_t                    max_batch_size = 4096; // Count of pending records which triggers write without waiting for `flush_interval`
+        };
+
+        struct Recovered
+        {
+            std::vector<Task> tasks{};        // Alive tasks ordered by id
+            std::vector<Task> dead_letters{}; // Dead letters ordered by id
+            size_t            next_id{};      // Greater than id of any task ever created
+        };
+
+        /**
+         * @brief Opens or creates the log and recovers tasks from it, appends go to the new segment
+         * @throws std::system_error if log can't be opened
+         */
+        explicit WriteAheadLog(Config config);
+        ~WriteAheadLog();
+
+        /**
+         * @brief Returns tasks recovered from the log on open, can be called once
+         */
+        Recovered TakeRecovered();
+
+        /**
+         * @brief Log* methods append records without waiting, records are durable once `WaitDurable` with returned sequence returns
+         * @throws std::system_error if log can't be written, log stays failed then
+         */
+        uint64_t LogCreate(std::span<const Task> tasks);
+        uint64_t LogDelete(std::span<const size_t> ids);
+        uint64_t LogAttempts(std::span<const Task> tasks, bool dead);
+        uint64_t LogNextId(size_t next_id);
+        void     WaitDurable(uint64_t sequence);
+
+        /**
+         * @brief Waits till appended records are durable and starts new segment, caller must not append concurrently
+         * @return number of the new segment or nothing if the log is a single empty segment already
+         */
+        std::optional<uint64_t> Rotate();
+
+        /**
+         * @brief Durably writes snapshot of all segments before `segment` and removes them
+         * @param dead_letters ids of dead letters among `tasks` in id order
+         */
+        void Snapshot(uint64_t segment, std::span<const Task> tasks, std::span<const size_t> dead_letters, size_t next_id);
+
+    private:
+        void     Recover();
+        void     OpenSegment(uint64_t segment);
+        uint64_t Append(std::string frames, size_t records);
+        void     Run();
+
+    private:
+        const Config m_config;
+        Recovered    m_recovered{};
+
+        std::mutex              m_mutex{};
+        std::condition_variable m_flush_cv{};
+        std::condition_variable m_durable_cv{};
+        int                     m_fd{-1};
+        uint64_t                m_segment{};         // Number of the segment appends go to
+        uint64_t                m_first_segment{};   // Number of the oldest segment not covered by snapshot
+        size_t                  m_segment_records{}; // Count of records appended to the current segment
+        std::string             m_pending{};
+        size_t                  m_pending_records{};
+        uint64_t                m_appended{};
+        uint64_t                m_durable{};
+        std::error_code         m_error{};
+        bool                    m_stopping{};
+        std::thread             m_flusher{};
+    };
+} // namespace backend::data_storage
@@ -17,15 +17,39 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace backend
 {
+    using Clock = std::chrono::system_clock;
+
+    /**
+     * @brief Time as whole milliseconds since Unix epoch, the way run time of a task is expressed
+     */
+    inline uint64_t ToUnixMilliseconds(Clock::time_point time)
+    {
+        return static_cast<uint64_t>(std::chrono::floor<std::chrono::milliseconds>(time.time_since_epoch()).count());
+    }
+
     struct TaskPayload
     {
+        // Longest name and description storages keep
+        static constexpr size_t max_name_size        = std::numeric_limits<uint16_t>::max();
+        static constexpr size_t max_description_size = std::numeric_limits<uint32_t>::max();
+
         std::string name{};
         std::string description{};
+        // Tasks of higher priority are dequeued first, tasks of the same priority are dequeued in creation order
+        uint8_t priority{};
+        // Unix time in milliseconds before which the task is not dequeued, 0 if the task is ready at once
+        uint64_t run_at{};
 
         auto operator<=>(const TaskPayload& rhs) const = default;
     };
@@ -34,7 +58,56 @@ namespace backend
     {
         size_t      id{};
         TaskPayload payload{};
+        // Count of failed deliveries, see RetryPolicy
+        uint32_t attempts{};
 
         auto operator<=>(const Task& rhs) const = default;
     };
+
+    /**
+     * @brief How failed tasks are redelivered: failure number N waits `backoff * 2^(N - 1)` capped by `max_backoff`,
+     * task is moved to dead letters once it fails `max_attempts` times (never if `max_attempts` is 0)
+     */
+    struct RetryPolicy
+    {
+        uint32_t        max_attempts{5};
+        Clock::duration backoff{std::chrono::seconds{1}};
+        Clock::duration max_backoff{std::chrono::minutes{5}};
+
+        Clock::duration Backoff(uint32_t attempts) const
+        {
+            auto result = backoff;
+            for (uint32_t i = 1; i < attempts && result > Clock::duration::zero() && result < max_backoff; ++i)
+                result *= 2;
+            return std::min(result, max_backoff);
+        }
+
+        bool IsExhausted(uint32_t attempts) const { return max_attempts != 0 && attempts >= max_attempts; }
+    };
+
+    /**
+     * @brief How long creations with the same idempotency key return the task created first.
+     * At most `max_keys` latest keys are remembered, so under heavier load keys are forgotten before `window` passes.
+     */
+    struct DedupPolicy
+    {
+        Clock::duration window{std::chrono::minutes{10}};
+        size_t          max_keys{100'000};
+    };
+
+    enum class FailResult : uint8_t
+    {
+        NotLeased,
+        Retried,
+        DeadLettered,
+    };
+
+    struct TasksPage
+    {
+        std::vector<Task> tasks{};
+        // id to pass as `after` to get the next page, empty if this page is the last one
+        std::optional<size_t> next{};
+
+        bool operator==(const TasksPage& rhs) const = default;
+    };
 } // namespace backend
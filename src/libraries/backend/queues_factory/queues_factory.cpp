@@ -0,0 +1,85 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "queues_factory.hpp"
+
+#include <libraries/backend/data_storage/combining_storage/combining_storage.hpp>
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/data_storage/wal_storage/wal_storage.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+namespace backend
+{
+    namespace
+    {
+        constexpr auto snapshot_interval = std::chrono::seconds{60};
+        constexpr auto queues_directory  = "queues";
+
+        /**
+         * @param queue name of the queue, its log is kept in `queues/<queue>` subdirectory of the default queue log
+         */
+        std::shared_ptr<DataStorage> MakeStorage(const QueuesOptions& options, std::optional<std::string_view> queue = {})
+        {
+            std::unique_ptr<DataStorage> storage = std::make_unique<data_storage::InMemoryStorage>();
+            if (options.wal_directory)
+            {
+                const auto directory = queue ? options.wal_directory.value() / queues_directory / queue.value() : options.wal_directory.value();
+                storage              = std::make_unique<data_storage::WalStorage>(std::move(storage), data_storage::WalStorage::Config{.directory = directory, .snapshot_interval = snapshot_interval});
+            }
+            if (options.combine)
+                storage = std::make_unique<data_storage::CombiningStorage>(std::move(storage));
+            return storage;
+        }
+
+        /**
+         * @brief Opens named queues logged before restart, otherwise they would be opened by the first request to them only,
+         * so their delayed tasks and expired leases would wait for it and they would be missing from the list of queues
+         */
+        void OpenLoggedQueues(const QueuesOptions& options, const QueuesManager& queues_manager)
+        {
+            if (!options.wal_directory || !std::filesystem::is_directory(options.wal_directory.value() / queues_directory))
+                return;
+
+            for (const auto& entry : std::filesystem::directory_iterator{options.wal_directory.value() / queues_directory})
+            {
+                if (!entry.is_directory())
+                    continue;
+
+                try
+                {
+                    queues_manager.GetQueue(entry.path().filename().string());
+                }
+                catch (const std::invalid_argument& e)
+                {
+                    std::cerr << "Skipped log of queue " << entry.path() << ": " << e.what() << "\n";
+                }
+            }
+        }
+    } // namespace
+
+    QueuesManager MakeQueuesManager(const QueuesOptions& options)
+    {
+        QueuesManager queues_manager{TasksManager{MakeStorage(options), options.retry_policy, options.dedup_policy}, [options](std::string_view queue) { return MakeStorage(options, queue); }, options.retry_policy, options.dedup_policy};
+        OpenLoggedQueues(options, queues_manager);
+        return queues_manager;
+    }
+} // namespace backend
@@ -0,0 +1,43 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/tasks_manager/queues_manager.hpp>
+
+#include <filesystem>
+#include <optional>
+
+namespace backend
+{
+    /**
+     * @brief How storages of queues are built: in-memory by default, durable with write-ahead log and snapshots in `wal_directory` if it is set,
+     * `combine` batches concurrent task creations through flat combining
+     */
+    struct QueuesOptions
+    {
+        std::optional<std::filesystem::path> wal_directory{};
+        bool                                 combine{};
+        RetryPolicy                          retry_policy{};
+        DedupPolicy                          dedup_policy{};
+    };
+
+    /**
+     * @brief Queues as served by the backend, named queues logged before restart are opened at once
+     */
+    QueuesManager MakeQueuesManager(const QueuesOptions& options);
+} // namespace backend
@@ -0,0 +1,63 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <libraries/backend/interface/task/task.hpp>
+#include <libraries/rest/router/rest_router.hpp>
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr auto content_types = {rest::ContentType::ApplicationJson, rest::ContentType::ApplicationMsgpack, rest::ContentType::ApplicationCbor};
+
+    template<typename T>
+    void BenchFormats(const std::string& title, const T& value)
+    {
+        ankerl::nanobench::Bench encode{};
+        encode.title("Encode " + title).unit("item").relative(true).minEpochIterations(10'000);
+
+        ankerl::nanobench::Bench decode{};
+        decode.title("Decode " + title).unit("item").relative(true).minEpochIterations(10'000);
+
+        for (const auto content_type : content_types)
+        {
+            const auto name    = std::string{rest::ParseContentType(content_type)};
+            const auto encoded = rest::Serialize(value, content_type);
+            REQUIRE(rest::DeSerialize<T>(encoded, content_type) == value);
+            std::cout << title << " as " << name << ": " << encoded.size() << " bytes\n";
+
+            encode.run(name, [&] { ankerl::nanobench::doNotOptimizeAway(rest::Serialize(value, content_type)); });
+            decode.run(name, [&] { ankerl::nanobench::doNotOptimizeAway(rest::DeSerialize<T>(encoded, content_type)); });
+        }
+    }
+} // namespace
+
+TEST_CASE("TaskPayload encode and decode cost by content type")
+{
+    // Typical producer request
+    BenchFormats("TaskPayload", backend::TaskPayload{.name = "send-email", .description = "Send welcome email to user 1234567"});
+}
+
+TEST_CASE("Task encode and decode cost by content type")
+{
+    // Typical item of consumer response
+    BenchFormats("Task", backend::Task{.id = 123'456'789, .payload = backend::TaskPayload{.name = "send-email", .description = "Send welcome email to user 1234567"}});
+}
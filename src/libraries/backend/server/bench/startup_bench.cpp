@@ -0,0 +1,100 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <boost/beast.hpp>
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/data_storage/wal_storage/wal_storage.hpp>
+#include <libraries/backend/queues_factory/queues_factory.hpp>
+#include <libraries/backend/server/server.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+namespace
+{
+    constexpr size_t tasks_count = 10'000'000;
+
+    /**
+     * @brief Fills log at `directory` with `tasks_count` tasks, half of them dequeued, optionally covered by snapshot
+     */
+    void PrepareLog(const std::filesystem::path& directory, bool snapshot)
+    {
+        std::filesystem::remove_all(directory);
+
+        std::vector<backend::Task> tasks(tasks_count);
+        for (size_t i = 0; i < tasks_count; ++i)
+            tasks[i] = backend::Task{.id = i, .payload = backend::TaskPayload{.name = "task " + std::to_string(i), .description = "description"}};
+
+        // Log doesn't depend on the storage that wrote it, so every task is written at once while the restarted server gets the capacity backend_app has
+        const auto storage = std::make_unique<backend::data_storage::WalStorage>(std::make_unique<backend::data_storage::InMemoryStorage>(tasks_count), backend::data_storage::WalStorage::Config{.directory = directory});
+        storage->Restore(std::move(tasks), {}, tasks_count);
+        storage->Dequeue(tasks_count / 2);
+        if (snapshot)
+            storage->Snapshot();
+    }
+
+    http::status GetTask(uint16_t port, size_t id)
+    {
+        net::io_context   ioc;
+        beast::tcp_stream stream(ioc);
+        stream.connect(tcp::endpoint{net::ip::make_address("127.0.0.1"), port});
+
+        http::request<http::string_body> req{http::verb::get, "/tasks/" + std::to_string(id), 11};
+        req.set(http::field::content_type, "application/json");
+        req.set(http::field::accept, "application/json");
+        http::write(stream, req);
+
+        beast::flat_buffer                buffer;
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        return res.result();
+    }
+
+    void BenchStartup(ankerl::nanobench::Bench& bench, const std::string& name, bool snapshot)
+    {
+        const auto directory = std::filesystem::temp_directory_path() / "startup_bench_wal";
+        PrepareLog(directory, snapshot);
+
+        bench.run(name, [&] {
+            // Same steps as backend_app does with `--wal` till the first request is served
+            const auto queues_manager = backend::MakeQueuesManager(backend::QueuesOptions{.wal_directory = directory});
+            const auto server         = backend::StartServer(queues_manager, rest::ServerConfig{.port = 8095});
+            REQUIRE(GetTask(8095, tasks_count - 1) == http::status::ok);
+            server.Stop();
+        });
+
+        std::filesystem::remove_all(directory);
+    }
+} // namespace
+
+TEST_CASE("Time to first request after restart")
+{
+    ankerl::nanobench::Bench bench{};
+    bench.title("Restart with " + std::to_string(tasks_count) + " tasks in log, half of them dequeued").unit("start").epochs(3).epochIterations(1).relative(true);
+
+    BenchStartup(bench, "full log replay", false);
+    BenchStartup(bench, "snapshot + log tail", true);
+}
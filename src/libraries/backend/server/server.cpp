@@ -17,32 +17,439 @@
 
 #include "server.hpp"
 
+#include <libraries/rest/async_event/async_event.hpp>
 #include <libraries/rest/router/rest_router.hpp>
+#include <libraries/utils/lazy_registry.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace backend
 {
-    rest::StopHandler StartServer(const TasksManager& tasks_manager, const rest::ServerConfig& config)
+    namespace
     {
-        rest::Router router{};
+        constexpr auto default_lease      = std::chrono::seconds{30};
+        constexpr auto max_wait           = std::chrono::seconds{60};
+        constexpr auto timers_period      = std::chrono::milliseconds{10};
+        constexpr auto default_page_limit = size_t{100};
+        constexpr auto max_page_limit     = size_t{1000};
+        constexpr auto max_batch_size     = size_t{10'000};
+        // Longest duration a parameter takes (e.g. delay of created tasks): long enough for any schedule and far from overflowing the clock
+        constexpr auto max_duration = std::chrono::days{365};
 
-        router.AddRoute("/tasks", rest::Request::Method::Get, [tasks_manager](const rest::None&, const rest::Router::Params&) {
-            return tasks_manager.GetTasks();
-        });
+        /**
+         * @brief Body of task creation. Fields added after the first release are optional, so existing clients keep working.
+         * Run time is given either by `run_at` (Unix time in milliseconds) or by "delay" parameter
+         */
+        struct NewTask
+        {
+            std::string             name{};
+            std::string             description{};
+            std::optional<uint8_t>  priority{};
+            std::optional<uint64_t> run_at{};
+        };
 
-        router.AddRoute("/tasks", rest::Request::Method::Post, [tasks_manager](const TaskPayload& task, const rest::Router::Params&) {
-            return tasks_manager.CreateTask(task);
-        });
+        /**
+         * @param run_at run time given by "delay" parameter
+         * @throws rest::BadParameter if run time is given by both the body and "delay", so neither of them is silently ignored,
+         * or if name or description is longer than storages keep
+         */
+        TaskPayload ToPayload(const NewTask& task, std::optional<uint64_t> run_at)
+        {
+            if (task.name.size() > TaskPayload::max_name_size)
+                throw rest::BadParameter("Name must be at most " + std::to_string(TaskPayload::max_name_size) + " bytes");
+            if (task.description.size() > TaskPayload::max_description_size)
+                throw rest::BadParameter("Description must be at most " + std::to_string(TaskPayload::max_description_size) + " bytes");
+            if (run_at && task.run_at)
+                throw rest::BadParameter("Run time must be given either by run_at or by delay");
+            return TaskPayload{.name = task.name, .description = task.description, .priority = task.priority.value_or(0), .run_at = run_at.value_or(task.run_at.value_or(0))};
+        }
 
-        router.AddRoute("/tasks/{:id}", rest::Request::Method::Get, [tasks_manager](const rest::None&, const rest::Router::Params& params) {
-            auto task = tasks_manager.GetTask(std::stoull(params.at("id")));
-            return rest::Router::SerializableResponse<std::optional<Task>>{.status_code = task ? rest::Response::Status::Ok : rest::Response::Status::NoContent, .body = std::move(task)};
-        });
+        /**
+         * @brief Parses duration like "500ms", "30s" or "5m", number without suffix is treated as seconds
+         * @throws rest::BadParameter if duration is invalid or longer than `max_duration`
+         */
+        Clock::duration ParseDuration(std::string_view value)
+        {
+            uint64_t   count{};
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), count);
+            if (ec != std::errc{} || ptr == value.data())
+                throw rest::BadParameter("Invalid duration: " + std::string{value});
+
+            std::chrono::milliseconds unit{};
+            const auto                suffix = value.substr(static_cast<size_t>(ptr - value.data()));
+            if (suffix == "ms")
+                unit = std::chrono::milliseconds{1};
+            else if (suffix.empty() || suffix == "s")
+                unit = std::chrono::seconds{1};
+            else if (suffix == "m")
+                unit = std::chrono::minutes{1};
+            else
+                throw rest::BadParameter("Invalid duration: " + std::string{value});
+
+            // Count is checked before it is multiplied, so a huge one can't overflow
+            if (count > static_cast<uint64_t>(max_duration / unit))
+                throw rest::BadParameter("Duration must be at most " + std::to_string(max_duration.count()) + " days");
+            return unit * static_cast<int64_t>(count);
+        }
+
+        Clock::duration GetLease(const rest::Router::Params& params)
+        {
+            const auto value = params.Find("lease");
+            return value ? ParseDuration(value.value()) : default_lease;
+        }
+
+        /**
+         * @throws rest::BadParameter if wait is longer than `max_wait`, so a client can't park a session for unbounded time
+         */
+        Clock::duration GetWait(const rest::Router::Params& params)
+        {
+            const auto value = params.Find("wait");
+            if (!value)
+                return {};
+
+            const auto wait = ParseDuration(value.value());
+            if (wait > max_wait)
+                throw rest::BadParameter("Wait must be at most " + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(max_wait).count()) + "s");
+            return wait;
+        }
+
+        /**
+         * @brief Run time of created tasks given as "delay" from now, empty if tasks keep their own run time
+         */
+        std::optional<uint64_t> GetRunAt(const rest::Router::Params& params)
+        {
+            const auto value = params.Find("delay");
+            if (!value)
+                return {};
+            return ToUnixMilliseconds(Clock::now() + ParseDuration(value.value()));
+        }
+
+        std::optional<std::string_view> GetIdempotencyKey(const rest::Router::Params& params)
+        {
+            const auto key = params.Find("idempotency_key");
+            if (key && key->size() > TasksManager::max_idempotency_key_size)
+                throw rest::BadParameter("Idempotency key must be at most " + std::to_string(TasksManager::max_idempotency_key_size) + " characters");
+            return key;
+        }
+
+        size_t GetCount(const rest::Router::Params& params)
+        {
+            return params.Get<size_t>("count", 1);
+        }
+
+        std::optional<size_t> GetAfter(const rest::Router::Params& params)
+        {
+            if (!params.Find("after"))
+                return {};
+            return params.Get<size_t>("after");
+        }
+
+        size_t GetLimit(const rest::Router::Params& params)
+        {
+            const auto limit = params.Get<size_t>("limit", default_page_limit);
+            if (limit == 0 || limit > max_page_limit)
+                throw rest::BadParameter("Limit must be in range [1, " + std::to_string(max_page_limit) + "]");
+            return limit;
+        }
+
+        void CheckBatchSize(size_t size)
+        {
+            if (size == 0 || size > max_batch_size)
+                throw rest::BadParameter("Batch size must be in range [1, " + std::to_string(max_batch_size) + "]");
+        }
+
+        /**
+         * @brief Streams all tasks reading the storage page by page while the response is written, so the whole listing is never copied at once
+         */
+        rest::Stream<Task> StreamTasks(const TasksManager& tasks_manager)
+        {
+            struct Cursor
+            {
+                TasksPage page{};
+                size_t    index{};
+                bool      started{};
+            };
+
+            return rest::Stream<Task>{[tasks_manager, cursor = std::make_shared<Cursor>()]() -> std::optional<Task> {
+                if (cursor->index == cursor->page.tasks.size())
+                {
+                    if (cursor->started && !cursor->page.next)
+                        return {};
+
+                    cursor->page    = tasks_manager.GetTasks(cursor->page.next, max_page_limit);
+                    cursor->index   = 0;
+                    cursor->started = true;
+                    if (cursor->page.tasks.empty())
+                        return {};
+                }
+                return std::move(cursor->page.tasks[cursor->index++]);
+            }};
+        }
+
+        /**
+         * @brief Conflict if task is not in the state the request expects (e.g. not leased)
+         */
+        rest::Router::SerializableResponse<rest::None> StateResponse(bool applied)
+        {
+            return {.status_code = applied ? rest::Response::Status::Ok : rest::Response::Status::Conflict, .body = rest::None{}};
+        }
+
+        /**
+         * @brief Queue as seen by the server: its tasks and notification of its own long polling consumers only
+         */
+        struct Queue
+        {
+            TasksManager tasks_manager;
+
+            // Notified whenever tasks become available for dequeue, so long polling consumers are woken up without polling the storage
+            mutable rest::AsyncEvent tasks_available{};
+        };
+
+        /**
+         * @brief Queues served by the server, named queue is created on the first request to it.
+         * @details Lookup of an existing queue takes no locks, so requests to different queues share nothing but the io_context.
+         */
+        class Queues
+        {
+        public:
+            explicit Queues(QueuesManager manager)
+                : m_manager{std::move(manager)}
+                , m_default{.tasks_manager = m_manager.GetDefaultQueue()}
+            {
+            }
+
+            const Queue& GetDefault() const { return m_default; }
+
+            /**
+             * @throws rest::BadParameter if queue name is invalid or there are too many queues
+             */
+            const Queue& Get(std::string_view name)
+            {
+                if (const auto* queue = m_queues.Find(name))
+                    return *queue;
+
+                try
+                {
+                    return m_queues.GetOrCreate(name, [&] { return Queue{.tasks_manager = m_manager.GetQueue(name)}; });
+                }
+                catch (const std::logic_error& e)
+                {
+                    throw rest::BadParameter(e.what());
+                }
+            }
+
+            std::vector<std::string> GetNames() const { return m_manager.GetQueueNames(); }
+
+            /**
+             * @brief Expires leases and promotes delayed tasks of every queue, waking up consumers of queues with new available tasks
+             */
+            void Tick() const
+            {
+                Tick(m_default.tasks_manager, &m_default);
+                m_manager.ForEachQueue([this](std::string_view name, const TasksManager& tasks_manager) { Tick(tasks_manager, m_queues.Find(name)); });
+            }
+
+        private:
+            static void Tick(const TasksManager& tasks_manager, const Queue* queue)
+            {
+                const auto available = tasks_manager.ExpireLeases() + tasks_manager.PromoteDelayed();
+                if (available != 0 && queue)
+                    queue->tasks_available.Notify(available);
+            }
+
+        private:
+            QueuesManager              m_manager;
+            Queue                      m_default;
+            utils::LazyRegistry<Queue> m_queues{QueuesManager::max_queues};
+        };
+
+        /**
+         * @brief Resolves queue of a request: the one named by `{:queue}` path parameter or the default one
+         */
+        struct QueueResolver
+        {
+            std::shared_ptr<Queues> queues;
+            bool                    named;
+
+            const Queue& operator()(const rest::Router::Params& params) const { return named ? queues->Get(params.At("queue")) : queues->GetDefault(); }
+        };
+
+        /**
+         * @brief Adds routes of tasks collection `prefix`/tasks and its dead letters `prefix`/dead-letters
+         */
+        void AddTasksRoutes(rest::Router& router, const std::string& prefix, const QueueResolver& get_queue)
+        {
+            router.AddRoute(prefix + "/tasks", rest::Request::Method::Get, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return queue.tasks_manager.GetTasks(GetAfter(params), GetLimit(params));
+            });
+
+            router.AddRoute(prefix + "/tasks/stream", rest::Request::Method::Get, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return StreamTasks(queue.tasks_manager);
+            });
+
+            router.AddRoute(prefix + "/tasks", rest::Request::Method::Post, [get_queue](const NewTask& new_task, const rest::Router::Params& params) {
+                const auto& queue   = get_queue(params);
+                const auto  payload = ToPayload(new_task, GetRunAt(params));
+                const auto  key     = GetIdempotencyKey(params);
+
+                std::optional<CreatedTask> created{};
+                try
+                {
+                    created = queue.tasks_manager.CreateTask(payload, key);
+                }
+                catch (const std::length_error&)
+                {
+                    // Queue is full: same status as the batch route gives for tasks it couldn't create, so the client retries later
+                    return rest::Router::SerializableResponse<std::optional<Task>>{.status_code = rest::Response::Status::InsufficientStorage, .body = std::optional<Task>{}};
+                }
+
+                // Creation with the same idempotency key is in progress: it isn't awaited on the server thread, the client repeats the request later
+                if (!created)
+                    return rest::Router::SerializableResponse<std::optional<Task>>{.status_code = rest::Response::Status::Conflict, .body = std::optional<Task>{}};
+
+                // Repeated creation created nothing, so there is nothing to wake consumers for
+                if (created->created)
+                    queue.tasks_available.Notify(1);
+                return rest::Router::SerializableResponse<std::optional<Task>>{.status_code = rest::Response::Status::Ok, .body = std::optional{std::move(created->task)}};
+            });
+
+            // Batch routes go through the storage in one pass: one lock per touched shard and one WAL record per request
+            router.AddRoute(prefix + "/tasks/batch", rest::Request::Method::Post, [get_queue](const std::vector<NewTask>& new_tasks, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                CheckBatchSize(new_tasks.size());
+
+                const auto               run_at = GetRunAt(params);
+                std::vector<TaskPayload> payloads{};
+                payloads.reserve(new_tasks.size());
+                for (const auto& new_task : new_tasks)
+                    payloads.push_back(ToPayload(new_task, run_at));
+
+                auto tasks = queue.tasks_manager.CreateTasks(payloads);
+                // One consumer per created task is woken, the rest of them keep sleeping instead of racing for nothing
+                if (!tasks.empty())
+                    queue.tasks_available.Notify(tasks.size());
+
+                // Queue got full in the middle of the batch: created prefix is returned, so the client retries the rest only
+                const auto status = tasks.size() == payloads.size() ? rest::Response::Status::Ok : rest::Response::Status::InsufficientStorage;
+                return rest::Router::SerializableResponse<std::vector<Task>>{.status_code = status, .body = std::move(tasks)};
+            });
+
+            router.AddRoute(prefix + "/tasks/batch/get", rest::Request::Method::Post, [get_queue](const std::vector<size_t>& ids, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                CheckBatchSize(ids.size());
+                return queue.tasks_manager.GetTasks(ids);
+            });
+
+            router.AddRoute(prefix + "/tasks/batch/delete", rest::Request::Method::Post, [get_queue](const std::vector<size_t>& ids, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                CheckBatchSize(ids.size());
+                queue.tasks_manager.DeleteTasks(ids);
+                return rest::None{};
+            });
+
+            router.AddRoute(prefix + "/tasks/dequeue", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return queue.tasks_manager.Dequeue(GetCount(params));
+            });
+
+            router.AddRoute(prefix + "/tasks/next", rest::Request::Method::Get, [get_queue](const rest::None&, const rest::Router::Params& params) -> boost::asio::awaitable<rest::Router::SerializableResponse<std::vector<Task>>> {
+                const auto& queue    = get_queue(params);
+                const auto  count    = GetCount(params);
+                const auto  deadline = std::chrono::steady_clock::now() + GetWait(params);
+                while (true)
+                {
+                    // Epoch is taken before dequeue, so task created in between doesn't get lost
+                    const auto epoch = queue.tasks_available.Epoch();
+                    if (auto tasks = queue.tasks_manager.Dequeue(count); !tasks.empty())
+                        co_return rest::Router::SerializableResponse<std::vector<Task>>{.status_code = rest::Response::Status::Ok, .body = std::move(tasks)};
+
+                    if (!co_await queue.tasks_available.Wait(epoch, deadline))
+                        co_return rest::Router::SerializableResponse<std::vector<Task>>{.status_code = rest::Response::Status::NoContent, .body = std::vector<Task>{}};
+                }
+            });
+
+            router.AddRoute(prefix + "/tasks/claim", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return queue.tasks_manager.Claim(GetCount(params), GetLease(params));
+            });
+
+            router.AddRoute(prefix + "/tasks/{:id:u64}/ack", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return StateResponse(queue.tasks_manager.Ack(params.Get<uint64_t>("id")));
+            });
+
+            router.AddRoute(prefix + "/tasks/{:id:u64}/nack", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue  = get_queue(params);
+                const auto  nacked = queue.tasks_manager.Nack(params.Get<uint64_t>("id"));
+                if (nacked)
+                    queue.tasks_available.Notify(1);
+                return StateResponse(nacked);
+            });
+
+            router.AddRoute(prefix + "/tasks/{:id:u64}/fail", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue  = get_queue(params);
+                const auto  result = queue.tasks_manager.Fail(params.Get<uint64_t>("id"));
+                if (result == FailResult::Retried)
+                    queue.tasks_available.Notify(1);
+                return rest::Router::SerializableResponse<FailResult>{.status_code = result == FailResult::NotLeased ? rest::Response::Status::Conflict : rest::Response::Status::Ok, .body = result};
+            });
+
+            router.AddRoute(prefix + "/tasks/{:id:u64}/lease", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return StateResponse(queue.tasks_manager.ExtendLease(params.Get<uint64_t>("id"), GetLease(params)));
+            });
+
+            router.AddRoute(prefix + "/tasks/{:id:u64}", rest::Request::Method::Get, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                auto        task  = queue.tasks_manager.GetTask(params.Get<uint64_t>("id"));
+                return rest::Router::SerializableResponse<std::optional<Task>>{.status_code = task ? rest::Response::Status::Ok : rest::Response::Status::NoContent, .body = std::move(task)};
+            });
+
+            router.AddRoute(prefix + "/tasks/{:id:u64}", rest::Request::Method::Delete, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                queue.tasks_manager.DeleteTask(params.Get<uint64_t>("id"));
+                return rest::None{};
+            });
+
+            router.AddRoute(prefix + "/dead-letters", rest::Request::Method::Get, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue = get_queue(params);
+                return queue.tasks_manager.GetDeadLetters();
+            });
+
+            router.AddRoute(prefix + "/dead-letters/{:id:u64}/redrive", rest::Request::Method::Post, [get_queue](const rest::None&, const rest::Router::Params& params) {
+                const auto& queue    = get_queue(params);
+                const auto  redriven = queue.tasks_manager.Redrive(params.Get<uint64_t>("id"));
+                if (redriven)
+                    queue.tasks_available.Notify(1);
+                return StateResponse(redriven);
+            });
+        }
+    } // namespace
+
+    rest::StopHandler StartServer(const QueuesManager& queues_manager, const rest::ServerConfig& config)
+    {
+        rest::Router router{};
+
+        auto queues = std::make_shared<Queues>(queues_manager);
+        AddTasksRoutes(router, "", QueueResolver{.queues = queues, .named = false});
+        AddTasksRoutes(router, "/queues/{:queue}", QueueResolver{.queues = queues, .named = true});
 
-        router.AddRoute("/tasks/{:id}", rest::Request::Method::Delete, [tasks_manager](const rest::None&, const rest::Router::Params& params) {
-            tasks_manager.DeleteTask(std::stoull(params.at("id")));
-            return rest::None{};
+        router.AddRoute("/queues", rest::Request::Method::Get, [queues](const rest::None&, const rest::Router::Params&) {
+            return queues->GetNames();
         });
 
-        return rest::StartServer(std::move(router), config);
+        // Leases and delayed tasks are kept in timing wheels, so frequent ticks cost nothing while nothing is due
+        return rest::StartServer(std::move(router), config, {rest::PeriodicTask{.interval = timers_period, .callback = [queues] { queues->Tick(); }}});
     }
 } // namespace backend
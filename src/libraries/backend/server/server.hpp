@@ -17,10 +17,13 @@
 
 #pragma once
 
-#include <libraries/backend/tasks_manager/tasks_manager.hpp>
+#include <libraries/backend/tasks_manager/queues_manager.hpp>
 #include <libraries/rest/server/rest_server.hpp>
 
 namespace backend
 {
-    rest::StopHandler StartServer(const TasksManager& tasks_manager, const rest::ServerConfig& config);
+    /**
+     * @brief Serves the default queue at `/tasks` and every named queue at `/queues/{name}/tasks`
+     */
+    rest::StopHandler StartServer(const QueuesManager& queues_manager, const rest::ServerConfig& config);
 } // namespace backend
@@ -0,0 +1,153 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <boost/beast.hpp>
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/server/server.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+namespace
+{
+    constexpr uint16_t port = 8086;
+
+    /**
+     * @brief Serves queues over in-memory storages of `queue_capacity` each
+     */
+    rest::StopHandler StartServer(size_t queue_capacity = backend::data_storage::InMemoryStorage::default_queue_capacity)
+    {
+        const auto make_storage = [queue_capacity](std::string_view) { return std::make_shared<backend::data_storage::InMemoryStorage>(queue_capacity); };
+
+        backend::QueuesManager queues_manager{backend::TasksManager{make_storage({})}, make_storage};
+        return backend::StartServer(queues_manager, rest::ServerConfig{.port = port});
+    }
+
+    http::response<http::string_body> MakeRequest(http::verb method, const std::string& target, std::string body = {})
+    {
+        net::io_context   ioc;
+        beast::tcp_stream stream(ioc);
+        stream.connect(tcp::endpoint{net::ip::make_address("127.0.0.1"), port});
+
+        http::request<http::string_body> req{method, target, 11};
+        req.set(http::field::content_type, "application/json");
+        req.set(http::field::accept, "application/json");
+        req.body() = std::move(body);
+        req.prepare_payload();
+        http::write(stream, req);
+
+        beast::flat_buffer                buffer;
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        return res;
+    }
+} // namespace
+
+TEST_CASE("Server rejects tasks above queue capacity")
+{
+    const auto server = StartServer(1);
+    REQUIRE(MakeRequest(http::verb::post, "/tasks", R"({"name": "first", "description": ""})").result() == http::status::ok);
+
+    SUBCASE("single task")
+    {
+        CHECK(MakeRequest(http::verb::post, "/tasks", R"({"name": "second", "description": ""})").result() == http::status::insufficient_storage);
+    }
+
+    SUBCASE("batch")
+    {
+        CHECK(MakeRequest(http::verb::post, "/tasks/batch", R"([{"name": "second", "description": ""}])").result() == http::status::insufficient_storage);
+    }
+
+    server.Stop();
+}
+
+TEST_CASE("Server creates task repeated by idempotency key once")
+{
+    const auto server = StartServer();
+
+    const auto first = MakeRequest(http::verb::post, "/tasks?idempotency_key=key", R"({"name": "first", "description": ""})");
+    REQUIRE(first.result() == http::status::ok);
+
+    const auto repeated = MakeRequest(http::verb::post, "/tasks?idempotency_key=key", R"({"name": "first", "description": ""})");
+    CHECK(repeated.result() == http::status::ok);
+    CHECK(repeated.body() == first.body());
+
+    const auto other = MakeRequest(http::verb::post, "/tasks?idempotency_key=other", R"({"name": "first", "description": ""})");
+    CHECK(other.result() == http::status::ok);
+    CHECK(other.body() != first.body());
+
+    server.Stop();
+}
+
+TEST_CASE("Server holds task till its run time")
+{
+    using namespace std::chrono_literals;
+
+    const auto server = StartServer();
+    const auto run_at = std::to_string(backend::ToUnixMilliseconds(backend::Clock::now() + 300ms));
+
+    SUBCASE("run time in body")
+    {
+        REQUIRE(MakeRequest(http::verb::post, "/tasks", R"({"name": "delayed", "description": "", "run_at": )" + run_at + "}").result() == http::status::ok);
+        CHECK(MakeRequest(http::verb::post, "/tasks/dequeue").body() == "[]");
+
+        const auto next = MakeRequest(http::verb::get, "/tasks/next?wait=5s");
+        CHECK(next.result() == http::status::ok);
+        CHECK(backend::ToUnixMilliseconds(backend::Clock::now()) >= std::stoull(run_at));
+    }
+
+    SUBCASE("run time in both body and delay")
+    {
+        CHECK(MakeRequest(http::verb::post, "/tasks?delay=1s", R"({"name": "delayed", "description": "", "run_at": )" + run_at + "}").result() == http::status::bad_request);
+        CHECK(MakeRequest(http::verb::post, "/tasks/batch?delay=1s", R"([{"name": "delayed", "description": "", "run_at": )" + run_at + "}]").result() == http::status::bad_request);
+    }
+
+    server.Stop();
+}
+
+TEST_CASE("Server rejects durations above a year")
+{
+    const auto server = StartServer();
+
+    CHECK(MakeRequest(http::verb::post, "/tasks?delay=365m", R"({"name": "delayed", "description": ""})").result() == http::status::ok);
+    CHECK(MakeRequest(http::verb::post, "/tasks?delay=31536001", R"({"name": "delayed", "description": ""})").result() == http::status::bad_request);
+    CHECK(MakeRequest(http::verb::post, "/tasks?delay=18446744073709551615m", R"({"name": "delayed", "description": ""})").result() == http::status::bad_request);
+    CHECK(MakeRequest(http::verb::post, "/tasks/claim?lease=18446744073709551615m").result() == http::status::bad_request);
+
+    server.Stop();
+}
+
+TEST_CASE("Server rejects names longer than storages keep")
+{
+    const auto server = StartServer();
+    const auto body   = [](size_t name_size) { return R"({"name": ")" + std::string(name_size, 'n') + R"(", "description": ""})"; };
+
+    CHECK(MakeRequest(http::verb::post, "/tasks", body(backend::TaskPayload::max_name_size)).result() == http::status::ok);
+    CHECK(MakeRequest(http::verb::post, "/tasks", body(backend::TaskPayload::max_name_size + 1)).result() == http::status::bad_request);
+    CHECK(MakeRequest(http::verb::post, "/tasks/batch", "[" + body(backend::TaskPayload::max_name_size + 1) + "]").result() == http::status::bad_request);
+
+    server.Stop();
+}
@@ -0,0 +1,74 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/tasks_manager/tasks_manager.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ops_count = 100'000;
+
+    std::vector<std::string> MakeKeys(std::string_view prefix, size_t count)
+    {
+        std::vector<std::string> keys{};
+        keys.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            keys.push_back(std::string{prefix} + std::to_string(i));
+        return keys;
+    }
+
+    /**
+     * @brief Measures create + dequeue round trips where creation `i` goes with key `keys[i % keys.size()]` (no key if `keys` is empty)
+     */
+    void BenchCreate(ankerl::nanobench::Bench& bench, const std::string& name, const std::vector<std::string>& keys)
+    {
+        bench.run(name, [&] {
+            // Fresh manager per epoch, so keys repeat only within an epoch
+            const backend::TasksManager manager{std::make_shared<backend::data_storage::InMemoryStorage>()};
+            for (size_t i = 0; i < ops_count; ++i)
+            {
+                const auto key = keys.empty() ? std::optional<std::string_view>{} : std::optional<std::string_view>{keys[i % keys.size()]};
+                manager.CreateTask(backend::TaskPayload{.name = "name", .description = "description"}, key);
+                ankerl::nanobench::doNotOptimizeAway(manager.Dequeue(1));
+            }
+        });
+    }
+} // namespace
+
+TEST_CASE("Creation with idempotency keys")
+{
+    ankerl::nanobench::Bench bench{};
+    bench.title("Create + dequeue")
+        .unit("round trip")
+        .batch(ops_count)
+        .epochs(5)
+        .epochIterations(1)
+        .relative(true);
+
+    BenchCreate(bench, "no key", {});
+    BenchCreate(bench, "unique keys", MakeKeys("key-", ops_count));
+    BenchCreate(bench, "every key repeated 10 times", MakeKeys("key-", ops_count / 10));
+}
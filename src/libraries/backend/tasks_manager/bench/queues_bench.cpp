@@ -0,0 +1,88 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <libraries/backend/data_storage/in_memory_storage/in_memory_storage.hpp>
+#include <libraries/backend/tasks_manager/queues_manager.hpp>
+
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ops_count = 100'000;
+
+    backend::QueuesManager MakeQueuesManager()
+    {
+        return backend::QueuesManager{backend::TasksManager{std::make_shared<backend::data_storage::InMemoryStorage>()},
+                                      [](std::string_view) { return std::make_shared<backend::data_storage::InMemoryStorage>(); }};
+    }
+
+    /**
+     * @brief Measures create + dequeue round trips of one client of queue "cold" while `hot_threads_count` threads do the same on `hot_queue`
+     */
+    void BenchColdQueue(ankerl::nanobench::Bench& bench, const std::string& name, size_t hot_threads_count, std::string_view hot_queue)
+    {
+        const auto  queues_manager = MakeQueuesManager();
+        const auto& cold           = queues_manager.GetQueue("cold");
+        const auto& hot            = queues_manager.GetQueue(hot_queue);
+
+        std::vector<std::jthread> hot_threads{};
+        for (size_t i = 0; i < hot_threads_count; ++i)
+        {
+            hot_threads.emplace_back([&hot](std::stop_token stop) {
+                while (!stop.stop_requested())
+                {
+                    hot.CreateTask(backend::TaskPayload{.name = "hot", .description = "description"});
+                    ankerl::nanobench::doNotOptimizeAway(hot.Dequeue(1));
+                }
+            });
+        }
+
+        bench.run(name, [&] {
+            for (size_t i = 0; i < ops_count; ++i)
+            {
+                cold.CreateTask(backend::TaskPayload{.name = "cold", .description = "description"});
+                ankerl::nanobench::doNotOptimizeAway(cold.Dequeue(1));
+            }
+        });
+    }
+} // namespace
+
+TEST_CASE("Queue latency under traffic to another queue")
+{
+    for (const size_t hot_threads_count : {1, 4, 16})
+    {
+        ankerl::nanobench::Bench bench{};
+        bench.title("Create + dequeue on a quiet queue, " + std::to_string(hot_threads_count) + " hot threads")
+            .unit("round trip")
+            .batch(ops_count)
+            .epochs(5)
+            .epochIterations(1)
+            .relative(true);
+
+        BenchColdQueue(bench, "no hot traffic", 0, "hot");
+        BenchColdQueue(bench, "hot traffic to the same queue", hot_threads_count, "cold");
+        BenchColdQueue(bench, "hot traffic to another queue", hot_threads_count, "hot");
+    }
+}
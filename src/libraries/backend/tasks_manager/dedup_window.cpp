@@ -0,0 +1,92 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "dedup_window.hpp"
+
+#include <algorithm>
+
+namespace backend
+{
+    DedupWindow::DedupWindow(DedupPolicy policy, Clock::time_point now)
+        : m_window{policy.window}
+        , m_span{std::max(Clock::duration{1}, policy.window / static_cast<Clock::rep>(buckets_count - 1))}
+        , m_bucket_capacity{std::max<size_t>(1, policy.max_keys / buckets_count)}
+        , m_buckets(buckets_count, Bucket{m_bucket_capacity})
+    {
+        // Any key outlives (buckets_count - 1) spans before its bucket is recycled, so it is kept for the whole window
+        m_buckets[m_newest].start = now;
+    }
+
+    std::optional<size_t> DedupWindow::Find(std::string_view key, Clock::time_point now) const
+    {
+        const auto hash = Hash{}(key);
+        for (size_t i = 0; i < buckets_count; ++i)
+        {
+            const auto& bucket = m_buckets[(m_newest + buckets_count - i) % buckets_count];
+            if (!bucket.filter.MayContain(hash))
+                continue;
+
+            if (const auto itr = bucket.entries.find(key); itr != bucket.entries.end())
+            {
+                if (now - itr->second.created < m_window)
+                    return itr->second.id;
+                return {};
+            }
+        }
+        return {};
+    }
+
+    void DedupWindow::Remember(std::string_view key, size_t id, Clock::time_point now)
+    {
+        Rotate(now);
+
+        auto& bucket = m_buckets[m_newest];
+        bucket.filter.Insert(Hash{}(key));
+        bucket.entries.insert_or_assign(std::string{key}, Entry{.id = id, .created = now});
+    }
+
+    size_t DedupWindow::Size() const
+    {
+        size_t result = 0;
+        for (const auto& bucket : m_buckets)
+            result += bucket.entries.size();
+        return result;
+    }
+
+    void DedupWindow::Rotate(Clock::time_point now)
+    {
+        // Every elapsed span recycles one bucket, so after a long idle period each bucket is recycled once and not once per span
+        for (size_t i = 0; i < buckets_count; ++i)
+        {
+            const auto& newest = m_buckets[m_newest];
+            const bool  full   = newest.entries.size() >= m_bucket_capacity;
+            if (now < newest.start + m_span && !full)
+                return;
+
+            const auto start = full ? now : newest.start + m_span;
+            m_newest         = (m_newest + 1) % buckets_count;
+
+            auto& bucket = m_buckets[m_newest];
+            bucket.filter.Clear();
+            bucket.entries.clear();
+            bucket.start = start;
+        }
+
+        auto& newest = m_buckets[m_newest];
+        newest.start = std::max(newest.start, now - m_span + Clock::duration{1});
+    }
+} // namespace backend
@@ -0,0 +1,95 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <libraries/backend/interface/task/task.hpp>
+#include <libraries/utils/bloom_filter.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace backend
+{
+    /**
+     * @brief Not thread-safe index of ids of tasks created by idempotency key during the last `DedupPolicy::window`.
+     * @details Keys are kept in time buckets, each spans window / (buckets_count - 1), and the oldest bucket is recycled as a whole,
+     * so expiration costs nothing per key and memory is bounded by `DedupPolicy::max_keys`: when the newest bucket is full it is rotated early.
+     * Every bucket is fronted by a Bloom filter, so a key seen for the first time (the common case) is rejected without probing the hash maps.
+     */
+    class DedupWindow
+    {
+    public:
+        static constexpr size_t buckets_count = 8;
+
+        explicit DedupWindow(DedupPolicy policy, Clock::time_point now = Clock::now());
+
+        /**
+         * @return id remembered for `key` if it was remembered less than window ago
+         */
+        std::optional<size_t> Find(std::string_view key, Clock::time_point now) const;
+
+        void Remember(std::string_view key, size_t id, Clock::time_point now);
+
+        /**
+         * @brief Count of remembered keys, including expired ones whose bucket is not recycled yet
+         */
+        size_t Size() const;
+
+    private:
+        struct Entry
+        {
+            size_t            id{};
+            Clock::time_point created{};
+        };
+
+        struct Hash
+        {
+            using is_transparent = void;
+
+            size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+        };
+
+        struct Bucket
+        {
+            explicit Bucket(size_t capacity)
+                : filter{capacity}
+            {
+            }
+
+            Clock::time_point                                             start{};
+            utils::BloomFilter                                            filter;
+            std::unordered_map<std::string, Entry, Hash, std::equal_to<>> entries{};
+        };
+
+        void Rotate(Clock::time_point now);
+
+    private:
+        const Clock::duration m_window;
+        const Clock::duration m_span;
+        const size_t          m_bucket_capacity;
+
+        std::vector<Bucket>   m_buckets{};
+        size_t                m_newest{};
+    };
+} // namespace backend
@@ -0,0 +1,82 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+#include "queues_manager.hpp"
+
+#include <libraries/utils/lazy_registry.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace backend
+{
+    namespace
+    {
+        bool IsValidName(std::string_view name)
+        {
+            // Name is used as a path segment both in urls and on disk, so it has no characters with special meaning there
+            return !name.empty() && name.size() <= QueuesManager::max_queue_name_size && std::ranges::all_of(name, [](char c) {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+            });
+        }
+    } // namespace
+
+    struct QueuesManager::State
+    {
+        TasksManager                      default_queue;
+        StorageFactory                    factory;
+        RetryPolicy                       retry_policy;
+        DedupPolicy                       dedup_policy;
+        utils::LazyRegistry<TasksManager> queues{max_queues};
+    };
+
+    QueuesManager::QueuesManager(TasksManager default_queue, StorageFactory factory, RetryPolicy retry_policy, DedupPolicy dedup_policy)
+        : m_state{std::make_shared<State>(std::move(default_queue), std::move(factory), retry_policy, dedup_policy)}
+    {
+        if (!m_state->factory)
+            throw std::invalid_argument("Storage factory cannot be null");
+    }
+
+    const TasksManager& QueuesManager::GetDefaultQueue() const
+    {
+        return m_state->default_queue;
+    }
+
+    const TasksManager& QueuesManager::GetQueue(std::string_view name) const
+    {
+        if (const auto* queue = m_state->queues.Find(name))
+            return *queue;
+
+        if (!IsValidName(name))
+            throw std::invalid_argument("Invalid queue name: " + std::string{name});
+
+        return m_state->queues.GetOrCreate(name, [&] { return TasksManager{m_state->factory(name), m_state->retry_policy, m_state->dedup_policy}; });
+    }
+
+    void QueuesManager::ForEachQueue(const std::function<void(std::string_view, const TasksManager&)>& fn) const
+    {
+        m_state->queues.ForEach(fn);
+    }
+
+    std::vector<std::string> QueuesManager::GetQueueNames() const
+    {
+        std::vector<std::string> result{};
+        m_state->queues.ForEach([&result](std::string_view name, const TasksManager&) { result.emplace_back(name); });
+        std::ranges::sort(result);
+        return result;
+    }
+} // namespace backend
@@ -0,0 +1,70 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+#pragma once
+
+#include <libraries/backend/tasks_manager/tasks_manager.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace backend
+{
+    /**
+     * @brief Registry of named queues: every queue is a TasksManager over its own storage created on first access, so queues share no locks, ids or memory.
+     * @details Lookup of an existing queue takes no locks, so a hot queue doesn't slow down traffic to other queues. Copies share the same registry.
+     */
+    class QueuesManager
+    {
+    public:
+        using StorageFactory = std::function<std::shared_ptr<DataStorage>(std::string_view name)>;
+
+        static constexpr size_t max_queues          = 1024;
+        static constexpr size_t max_queue_name_size = 64;
+
+        /**
+         * @param default_queue queue addressed without a name
+         * @param factory creates storage of a named queue, invoked once per queue
+         * @param retry_policy retry policy of named queues
+         * @param dedup_policy deduplication policy of named queues
+         */
+        QueuesManager(TasksManager default_queue, StorageFactory factory, RetryPolicy retry_policy = {}, DedupPolicy dedup_policy = {});
+
+        const TasksManager& GetDefaultQueue() const;
+
+        /**
+         * @brief Returns queue `name`, creating it on first access
+         * @throws std::invalid_argument if `name` is empty, longer than max_queue_name_size or has characters other than letters, digits, '-' and '_'
+         * @throws std::length_error if `name` is new and there are max_queues queues already
+         */
+        const TasksManager& GetQueue(std::string_view name) const;
+
+        /**
+         * @brief Invokes `fn(name, queue)` for every named queue created so far
+         */
+        void ForEachQueue(const std::function<void(std::string_view, const TasksManager&)>& fn) const;
+
+        std::vector<std::string> GetQueueNames() const;
+
+    private:
+        struct State;
+
+        std::shared_ptr<State> m_state{};
+    };
+} // namespace backend
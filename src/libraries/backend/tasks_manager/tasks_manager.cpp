@@ -18,19 +18,100 @@
 #include "tasks_manager.hpp"
 
 #include <libraries/backend/data_storage/interface/data_storage.hpp>
+#include <libraries/backend/tasks_manager/dedup_window.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace backend
 {
-    TasksManager::TasksManager(std::shared_ptr<DataStorage> storage)
+    /**
+     * @brief Keys are striped over independent windows, so creations with different keys rarely wait for each other
+     */
+    struct TasksManager::Deduplication
+    {
+        static constexpr size_t stripes_count = 16;
+
+        struct Stripe
+        {
+            explicit Stripe(DedupPolicy policy)
+                : window{policy}
+            {
+            }
+
+            std::mutex               mutex{};
+            DedupWindow              window;    // Guarded by mutex
+            std::vector<std::string> pending{}; // Guarded by mutex, keys being created now: a few at most, so they are searched linearly
+        };
+
+        explicit Deduplication(DedupPolicy policy)
+        {
+            // Every stripe remembers at least one key, so tiny max_keys is exceeded a bit instead of disabling deduplication
+            policy.max_keys = std::max<size_t>(1, policy.max_keys / stripes_count);
+            for (size_t i = 0; i < stripes_count; ++i)
+                stripes.emplace_back(policy);
+        }
+
+        Stripe& GetStripe(std::string_view key) { return stripes[std::hash<std::string_view>{}(key) % stripes_count]; }
+
+        std::deque<Stripe> stripes{};
+    };
+
+    TasksManager::TasksManager(std::shared_ptr<DataStorage> storage, RetryPolicy retry_policy, DedupPolicy dedup_policy)
         : m_storage{std::move(storage)}
+        , m_retry_policy{retry_policy}
+        , m_dedup{std::make_shared<Deduplication>(dedup_policy)}
     {
     }
 
-    Task TasksManager::CreateTask(const TaskPayload& payload) const
+    std::optional<CreatedTask> TasksManager::CreateTask(const TaskPayload& payload, std::optional<std::string_view> idempotency_key) const
     {
-        return m_storage->CreateTask(payload);
+        if (!idempotency_key)
+            return CreatedTask{.task = m_storage->CreateTask(payload), .created = true};
+
+        if (idempotency_key->size() > max_idempotency_key_size)
+            throw std::invalid_argument("Idempotency key is too long");
+
+        const auto key    = idempotency_key.value();
+        auto&      stripe = m_dedup->GetStripe(key);
+
+        // Key is reserved as pending while the task is created without the lock (storage could wait for disk),
+        // so a concurrent repeat doesn't race the first creation and other keys of the stripe don't wait at all.
+        // The repeat doesn't wait for the first creation either, as the caller could be a thread serving other requests
+        std::unique_lock lock{stripe.mutex};
+        if (const auto id = stripe.window.Find(key, Clock::now()))
+        {
+            lock.unlock();
+            return CreatedTask{.task = m_storage->GetTask(id.value()).value_or(Task{.id = id.value(), .payload = payload}), .created = false};
+        }
+        if (std::ranges::find(stripe.pending, key) != stripe.pending.end())
+            return {};
+        stripe.pending.emplace_back(key);
+        lock.unlock();
+
+        std::optional<Task> task{};
+        try
+        {
+            task = m_storage->CreateTask(payload);
+        }
+        catch (...)
+        {
+            // Repeat retries the creation then
+            lock.lock();
+            std::erase(stripe.pending, key);
+            throw;
+        }
+
+        lock.lock();
+        std::erase(stripe.pending, key);
+        stripe.window.Remember(key, task->id, Clock::now());
+        return CreatedTask{.task = std::move(task).value(), .created = true};
     }
 
     std::vector<Task> TasksManager::GetTasks() const
@@ -38,6 +119,18 @@ namespace backend
         return m_storage->GetTasks();
     }
 
+    TasksPage TasksManager::GetTasks(std::optional<size_t> after, size_t limit) const
+    {
+        // One extra task tells whether the next page exists without an additional request
+        auto tasks = m_storage->GetTasks(after, limit + 1);
+        if (tasks.size() <= limit)
+            return {.tasks = std::move(tasks), .next = {}};
+
+        tasks.pop_back();
+        const auto next = tasks.empty() ? after : std::optional{tasks.back().id};
+        return {.tasks = std::move(tasks), .next = next};
+    }
+
     std::optional<Task> TasksManager::GetTask(size_t id) const
     {
         return m_storage->GetTask(id);
@@ -48,4 +141,69 @@ namespace backend
         m_storage->DeleteTask(id);
     }
 
+    std::vector<Task> TasksManager::CreateTasks(std::span<const TaskPayload> payloads) const
+    {
+        return m_storage->CreateTasks(payloads);
+    }
+
+    std::vector<Task> TasksManager::GetTasks(std::span<const size_t> ids) const
+    {
+        return m_storage->GetTasks(ids);
+    }
+
+    void TasksManager::DeleteTasks(std::span<const size_t> ids) const
+    {
+        m_storage->DeleteTasks(ids);
+    }
+
+    std::vector<Task> TasksManager::Dequeue(size_t count) const
+    {
+        return m_storage->Dequeue(count);
+    }
+
+    std::vector<Task> TasksManager::Claim(size_t count, Clock::duration lease) const
+    {
+        return m_storage->Claim(count, Clock::now() + lease);
+    }
+
+    bool TasksManager::Ack(size_t id) const
+    {
+        return m_storage->Ack(id);
+    }
+
+    bool TasksManager::Nack(size_t id) const
+    {
+        return m_storage->Nack(id);
+    }
+
+    FailResult TasksManager::Fail(size_t id) const
+    {
+        return m_storage->Fail(id, m_retry_policy, Clock::now());
+    }
+
+    std::vector<Task> TasksManager::GetDeadLetters() const
+    {
+        return m_storage->GetDeadLetters();
+    }
+
+    bool TasksManager::Redrive(size_t id) const
+    {
+        return m_storage->Redrive(id);
+    }
+
+    bool TasksManager::ExtendLease(size_t id, Clock::duration lease) const
+    {
+        return m_storage->ExtendLease(id, Clock::now() + lease);
+    }
+
+    size_t TasksManager::ExpireLeases() const
+    {
+        return m_storage->ExpireLeases(Clock::now());
+    }
+
+    size_t TasksManager::PromoteDelayed() const
+    {
+        return m_storage->PromoteDelayed(Clock::now());
+    }
+
 } // namespace backend
@@ -21,6 +21,8 @@
 
 #include <memory>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace backend
@@ -30,17 +32,57 @@ namespace backend
 
 namespace backend
 {
+    struct CreatedTask
+    {
+        Task task{};
+        // False if creation was repeated by idempotency key, so nothing was created
+        bool created{};
+
+        bool operator==(const CreatedTask& rhs) const = default;
+    };
+
     class TasksManager
     {
     public:
-        explicit TasksManager(std::shared_ptr<DataStorage> storage);
+        static constexpr size_t max_idempotency_key_size = 256;
+
+        /**
+         * @param retry_policy how tasks reported by Fail are redelivered
+         * @param dedup_policy how long tasks created by idempotency key are remembered
+         */
+        explicit TasksManager(std::shared_ptr<DataStorage> storage, RetryPolicy retry_policy = {}, DedupPolicy dedup_policy = {});
+
+        /**
+         * @brief Creation with `idempotency_key` repeated within DedupPolicy::window creates nothing and returns the task created first
+         * (with the repeated payload if that task is gone already)
+         * @return empty if creation with the same `idempotency_key` is in progress, it is not waited for: the caller repeats later
+         * @throws std::invalid_argument if `idempotency_key` is longer than max_idempotency_key_size
+         */
+        std::optional<CreatedTask> CreateTask(const TaskPayload& payload, std::optional<std::string_view> idempotency_key = {}) const;
 
-        Task                CreateTask(const TaskPayload& payload) const;
         std::vector<Task>   GetTasks() const;
+        TasksPage           GetTasks(std::optional<size_t> after, size_t limit) const;
         std::optional<Task> GetTask(size_t id) const;
         void                DeleteTask(size_t id) const;
+        std::vector<Task>   CreateTasks(std::span<const TaskPayload> payloads) const;
+        std::vector<Task>   GetTasks(std::span<const size_t> ids) const;
+        void                DeleteTasks(std::span<const size_t> ids) const;
+        std::vector<Task>   Dequeue(size_t count) const;
+        std::vector<Task>   Claim(size_t count, Clock::duration lease) const;
+        bool                Ack(size_t id) const;
+        bool                Nack(size_t id) const;
+        FailResult          Fail(size_t id) const;
+        std::vector<Task>   GetDeadLetters() const;
+        bool                Redrive(size_t id) const;
+        bool                ExtendLease(size_t id, Clock::duration lease) const;
+        size_t              ExpireLeases() const;
+        size_t              PromoteDelayed() const;
 
     private:
-        std::shared_ptr<DataStorage> m_storage{};
+        struct Deduplication;
+
+        std::shared_ptr<DataStorage>   m_storage{};
+        RetryPolicy                    m_retry_policy{};
+        std::shared_ptr<Deduplication> m_dedup{};
     };
 } // namespace backend
@@ -0,0 +1,85 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/backend/tasks_manager/dedup_window.hpp>
+
+#include <chrono>
+#include <string>
+
+TEST_CASE("DedupWindow remembers keys for the window")
+{
+    using namespace std::chrono_literals;
+
+    const auto           now = backend::Clock::now();
+    backend::DedupWindow window{backend::DedupPolicy{.window = 7min, .max_keys = 1'000}, now};
+
+    REQUIRE(!window.Find("a", now));
+    window.Remember("a", 1, now);
+    window.Remember("b", 2, now + 30s);
+    REQUIRE(window.Find("a", now) == 1);
+    REQUIRE(window.Find("b", now + 1min) == 2);
+    REQUIRE(!window.Find("c", now + 1min));
+    REQUIRE(window.Size() == 2);
+
+    SUBCASE("keys expire after the window")
+    {
+        REQUIRE(window.Find("a", now + 7min - 1ms) == 1);
+        REQUIRE(!window.Find("a", now + 7min));
+        REQUIRE(window.Find("b", now + 7min) == 2);
+    }
+
+    SUBCASE("expired key is remembered again")
+    {
+        window.Remember("a", 3, now + 8min);
+        REQUIRE(window.Find("a", now + 8min) == 3);
+    }
+
+    SUBCASE("keys are kept till their bucket is recycled")
+    {
+        for (size_t i = 1; i < backend::DedupWindow::buckets_count; ++i)
+            window.Remember(std::to_string(i), i, now + i * 1min);
+        REQUIRE(window.Size() == 2 + backend::DedupWindow::buckets_count - 1);
+
+        window.Remember("last", 100, now + 8min);
+        REQUIRE(window.Size() == backend::DedupWindow::buckets_count);
+        REQUIRE(window.Find("7", now + 8min) == 7);
+    }
+
+    SUBCASE("long idle period recycles everything")
+    {
+        window.Remember("c", 3, now + 24h);
+        REQUIRE(window.Size() == 1);
+        REQUIRE(window.Find("c", now + 24h) == 3);
+    }
+}
+
+TEST_CASE("DedupWindow is bounded")
+{
+    constexpr size_t max_keys = 80;
+
+    const auto           now = backend::Clock::now();
+    backend::DedupWindow window{backend::DedupPolicy{.window = std::chrono::hours{1}, .max_keys = max_keys}, now};
+
+    for (size_t i = 0; i < 10 * max_keys; ++i)
+        window.Remember(std::to_string(i), i, now);
+
+    REQUIRE(window.Size() <= max_keys);
+    REQUIRE(window.Find(std::to_string(10 * max_keys - 1), now) == 10 * max_keys - 1);
+    REQUIRE(!window.Find("0", now));
+}
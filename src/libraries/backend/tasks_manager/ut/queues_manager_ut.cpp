@@ -0,0 +1,101 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+#include <doctest/doctest.h>
+#include <doctest/trompeloeil.hpp>
+
+#include <libraries/backend/data_storage/interface/data_storage.hpp>
+#include <libraries/backend/data_storage/interface/data_storage_mock.hpp>
+#include <libraries/backend/tasks_manager/queues_manager.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("QueuesManager creates storage per queue on first access")
+{
+    auto                                                    default_storage = std::make_shared<MockDataStorage>();
+    std::map<std::string, std::shared_ptr<MockDataStorage>> storages{};
+
+    backend::QueuesManager manager{backend::TasksManager{default_storage}, [&storages](std::string_view name) {
+                                       auto storage = std::make_shared<MockDataStorage>();
+                                       REQUIRE(storages.emplace(name, storage).second);
+                                       return storage;
+                                   }};
+    REQUIRE(manager.GetQueueNames().empty());
+
+    const backend::Task task{.id = 1, .payload = {.name = "name"}};
+
+    SUBCASE("queue is created once")
+    {
+        const auto& first = manager.GetQueue("first");
+        REQUIRE(&manager.GetQueue("first") == &first);
+        REQUIRE(storages.size() == 1);
+
+        REQUIRE_CALL(*storages.at("first"), GetTask(1u)).RETURN(task);
+        REQUIRE(first.GetTask(1) == task);
+    }
+
+    SUBCASE("queues are independent")
+    {
+        manager.GetQueue("first");
+        manager.GetQueue("second");
+        REQUIRE(manager.GetQueueNames() == std::vector<std::string>{"first", "second"});
+
+        REQUIRE_CALL(*storages.at("second"), CreateTask(task.payload)).RETURN(task);
+        REQUIRE(manager.GetQueue("second").CreateTask(task.payload) == backend::CreatedTask{.task = task, .created = true});
+    }
+
+    SUBCASE("default queue is not named")
+    {
+        REQUIRE_CALL(*default_storage, Dequeue(1u)).RETURN(std::vector{task});
+        REQUIRE(manager.GetDefaultQueue().Dequeue(1) == std::vector{task});
+        REQUIRE(storages.empty());
+    }
+
+    SUBCASE("for each queue")
+    {
+        manager.GetQueue("first");
+        manager.GetQueue("second");
+
+        REQUIRE_CALL(*storages.at("first"), ExpireLeases(trompeloeil::_)).RETURN(1u);
+        REQUIRE_CALL(*storages.at("second"), ExpireLeases(trompeloeil::_)).RETURN(2u);
+
+        size_t expired = 0;
+        manager.ForEachQueue([&expired](std::string_view, const backend::TasksManager& queue) { expired += queue.ExpireLeases(); });
+        REQUIRE(expired == 3);
+    }
+
+    SUBCASE("invalid names")
+    {
+        for (const auto* name : {"", "a/b", "..", "a b", "queue%2F"})
+            REQUIRE_THROWS_AS(manager.GetQueue(name), std::invalid_argument);
+        REQUIRE_THROWS_AS(manager.GetQueue(std::string(backend::QueuesManager::max_queue_name_size + 1, 'q')), std::invalid_argument);
+        REQUIRE(storages.empty());
+
+        manager.GetQueue(std::string(backend::QueuesManager::max_queue_name_size, 'q'));
+        REQUIRE(storages.size() == 1);
+    }
+
+    SUBCASE("count of queues is bounded")
+    {
+        for (size_t i = 0; i < backend::QueuesManager::max_queues; ++i)
+            manager.GetQueue(std::to_string(i));
+        REQUIRE_THROWS_AS(manager.GetQueue("one-more"), std::length_error);
+        REQUIRE(storages.size() == backend::QueuesManager::max_queues);
+        manager.GetQueue("0");
+    }
+}
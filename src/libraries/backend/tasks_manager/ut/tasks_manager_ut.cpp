@@ -22,6 +22,11 @@
 #include <libraries/backend/data_storage/interface/data_storage_mock.hpp>
 #include <libraries/backend/tasks_manager/tasks_manager.hpp>
 
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
 TEST_CASE("TasksManager forwards calls to storage")
 {
     auto                  mock = std::make_shared<MockDataStorage>();
@@ -38,6 +43,37 @@ TEST_CASE("TasksManager forwards calls to storage")
         manager.CreateTask(payload);
     }
 
+    SUBCASE("CreateTask with idempotency key")
+    {
+        REQUIRE_CALL(*mock, CreateTask(payload)).RETURN(task).IN_SEQUENCE(s);
+        REQUIRE_CALL(*mock, GetTask(task.id)).RETURN(task).IN_SEQUENCE(s);
+        REQUIRE_CALL(*mock, GetTask(task.id)).RETURN(std::nullopt).IN_SEQUENCE(s);
+
+        REQUIRE(manager.CreateTask(payload, "key") == backend::CreatedTask{.task = task, .created = true});
+        REQUIRE(manager.CreateTask(payload, "key") == backend::CreatedTask{.task = task, .created = false});
+        REQUIRE(manager.CreateTask(payload, "key") == backend::CreatedTask{.task = backend::Task{.id = task.id, .payload = payload}, .created = false});
+        REQUIRE_THROWS_AS(manager.CreateTask(payload, std::string(backend::TasksManager::max_idempotency_key_size + 1, 'k')), std::invalid_argument);
+    }
+
+    SUBCASE("CreateTask with idempotency key being created")
+    {
+        std::optional<backend::CreatedTask> repeated{backend::CreatedTask{}};
+        REQUIRE_CALL(*mock, CreateTask(payload)).LR_SIDE_EFFECT(repeated = manager.CreateTask(payload, "key")).RETURN(task).IN_SEQUENCE(s);
+
+        // Repeat made while the first creation is in progress returns at once instead of waiting for it
+        REQUIRE(manager.CreateTask(payload, "key") == backend::CreatedTask{.task = task, .created = true});
+        REQUIRE(!repeated);
+    }
+
+    SUBCASE("CreateTask with idempotency key after failed creation")
+    {
+        REQUIRE_CALL(*mock, CreateTask(payload)).THROW(std::runtime_error{"failed"}).IN_SEQUENCE(s);
+        REQUIRE_CALL(*mock, CreateTask(payload)).RETURN(task).IN_SEQUENCE(s);
+
+        REQUIRE_THROWS_AS(manager.CreateTask(payload, "key"), std::runtime_error);
+        REQUIRE(manager.CreateTask(payload, "key") == backend::CreatedTask{.task = task, .created = true});
+    }
+
     SUBCASE("GetTasks")
     {
         const auto res = std::vector{task};
@@ -46,6 +82,26 @@ TEST_CASE("TasksManager forwards calls to storage")
         REQUIRE(manager.GetTasks() == res);
     }
 
+    SUBCASE("GetTasks page")
+    {
+        const auto first  = backend::Task{.id = 124, .payload = payload};
+        const auto second = backend::Task{.id = 130, .payload = payload};
+
+        SUBCASE("next page exists")
+        {
+            REQUIRE_CALL(*mock, GetTasks(std::optional<size_t>{100}, size_t{3})).RETURN(std::vector{task, first, second}).IN_SEQUENCE(s);
+
+            REQUIRE(manager.GetTasks(100, 2) == backend::TasksPage{.tasks = {task, first}, .next = 124});
+        }
+
+        SUBCASE("last page")
+        {
+            REQUIRE_CALL(*mock, GetTasks(std::optional<size_t>{}, size_t{3})).RETURN(std::vector{task, first}).IN_SEQUENCE(s);
+
+            REQUIRE(manager.GetTasks({}, 2) == backend::TasksPage{.tasks = {task, first}, .next = {}});
+        }
+    }
+
     SUBCASE("GetTask")
     {
         REQUIRE_CALL(*mock, GetTask(0)).RETURN(task).IN_SEQUENCE(s);
@@ -58,4 +114,105 @@ TEST_CASE("TasksManager forwards calls to storage")
         REQUIRE_CALL(*mock, DeleteTask(0)).IN_SEQUENCE(s);
         manager.DeleteTask(0);
     }
+
+    SUBCASE("CreateTasks")
+    {
+        const auto payloads = std::vector{payload, task.payload};
+        const auto res      = std::vector{task};
+        REQUIRE_CALL(*mock, CreateTasks(trompeloeil::_)).WITH(std::ranges::equal(_1, payloads)).RETURN(res).IN_SEQUENCE(s);
+
+        REQUIRE(manager.CreateTasks(payloads) == res);
+    }
+
+    SUBCASE("GetTasks by ids")
+    {
+        const auto ids = std::vector<size_t>{123, 7};
+        const auto res = std::vector{task};
+        REQUIRE_CALL(*mock, GetTasks(trompeloeil::_)).WITH(std::ranges::equal(_1, ids)).RETURN(res).IN_SEQUENCE(s);
+
+        REQUIRE(manager.GetTasks(ids) == res);
+    }
+
+    SUBCASE("DeleteTasks")
+    {
+        const auto ids = std::vector<size_t>{123, 7};
+        REQUIRE_CALL(*mock, DeleteTasks(trompeloeil::_)).WITH(std::ranges::equal(_1, ids)).IN_SEQUENCE(s);
+
+        manager.DeleteTasks(ids);
+    }
+
+    SUBCASE("Dequeue")
+    {
+        const auto res = std::vector{task};
+        REQUIRE_CALL(*mock, Dequeue(5)).RETURN(res).IN_SEQUENCE(s);
+
+        REQUIRE(manager.Dequeue(5) == res);
+    }
+
+    SUBCASE("Claim")
+    {
+        const auto res    = std::vector{task};
+        const auto before = backend::Clock::now();
+        REQUIRE_CALL(*mock, Claim(5, trompeloeil::_)).WITH(_2 >= before + std::chrono::seconds{30}).RETURN(res).IN_SEQUENCE(s);
+
+        REQUIRE(manager.Claim(5, std::chrono::seconds{30}) == res);
+    }
+
+    SUBCASE("Ack")
+    {
+        REQUIRE_CALL(*mock, Ack(0)).RETURN(true).IN_SEQUENCE(s);
+        REQUIRE(manager.Ack(0));
+    }
+
+    SUBCASE("Nack")
+    {
+        REQUIRE_CALL(*mock, Nack(0)).RETURN(false).IN_SEQUENCE(s);
+        REQUIRE(!manager.Nack(0));
+    }
+
+    SUBCASE("ExtendLease")
+    {
+        const auto before = backend::Clock::now();
+        REQUIRE_CALL(*mock, ExtendLease(0, trompeloeil::_)).WITH(_2 >= before + std::chrono::seconds{30}).RETURN(true).IN_SEQUENCE(s);
+
+        REQUIRE(manager.ExtendLease(0, std::chrono::seconds{30}));
+    }
+
+    SUBCASE("ExpireLeases")
+    {
+        const auto before = backend::Clock::now();
+        REQUIRE_CALL(*mock, ExpireLeases(trompeloeil::_)).WITH(_1 >= before).RETURN(3u).IN_SEQUENCE(s);
+
+        REQUIRE(manager.ExpireLeases() == 3);
+    }
+
+    SUBCASE("PromoteDelayed")
+    {
+        const auto before = backend::Clock::now();
+        REQUIRE_CALL(*mock, PromoteDelayed(trompeloeil::_)).WITH(_1 >= before).RETURN(2u).IN_SEQUENCE(s);
+
+        REQUIRE(manager.PromoteDelayed() == 2);
+    }
+
+    SUBCASE("Fail")
+    {
+        const auto before = backend::Clock::now();
+        REQUIRE_CALL(*mock, Fail(0, trompeloeil::_, trompeloeil::_)).WITH(_2.max_attempts == backend::RetryPolicy{}.max_attempts && _3 >= before).RETURN(backend::FailResult::Retried).IN_SEQUENCE(s);
+
+        REQUIRE(manager.Fail(0) == backend::FailResult::Retried);
+    }
+
+    SUBCASE("GetDeadLetters")
+    {
+        REQUIRE_CALL(*mock, GetDeadLetters()).RETURN(std::vector{task}).IN_SEQUENCE(s);
+
+        REQUIRE(manager.GetDeadLetters() == std::vector{task});
+    }
+
+    SUBCASE("Redrive")
+    {
+        REQUIRE_CALL(*mock, Redrive(0)).RETURN(true).IN_SEQUENCE(s);
+
+        REQUIRE(manager.Redrive(0));
+    }
 }
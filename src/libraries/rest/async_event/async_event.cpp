@@ -0,0 +1,89 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include "async_event.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+namespace net = boost::asio;
+
+namespace rest
+{
+    struct AsyncEvent::Waiter
+    {
+        // Timer is touched only from its strand, so cancellation can't race with start of the wait
+        net::steady_timer timer;
+        bool              notified{};
+
+        // Position in the waiters list to leave it on timeout, valid while not notified
+        std::list<std::shared_ptr<Waiter>>::iterator position{};
+    };
+
+    AsyncEvent::AsyncEvent() = default;
+
+    AsyncEvent::~AsyncEvent() = default;
+
+    uint64_t AsyncEvent::Epoch() const
+    {
+        std::lock_guard _{m_mutex};
+        return m_epoch;
+    }
+
+    void AsyncEvent::Notify(size_t count)
+    {
+        std::lock_guard _{m_mutex};
+        ++m_epoch;
+        for (; count != 0 && !m_waiters.empty(); --count)
+        {
+            auto waiter      = std::move(m_waiters.front());
+            waiter->notified = true;
+            m_waiters.pop_front();
+            net::post(waiter->timer.get_executor(), [waiter] { waiter->timer.cancel(); });
+        }
+    }
+
+    net::awaitable<bool> AsyncEvent::Wait(uint64_t epoch, std::chrono::steady_clock::time_point deadline)
+    {
+        const auto strand = net::make_strand(co_await net::this_coro::executor);
+        auto       waiter = std::make_shared<Waiter>(net::steady_timer{strand, deadline});
+        co_return co_await net::co_spawn(strand, WaitOnStrand(std::move(waiter), epoch), net::use_awaitable);
+    }
+
+    net::awaitable<bool> AsyncEvent::WaitOnStrand(std::shared_ptr<Waiter> waiter, uint64_t epoch)
+    {
+        {
+            std::lock_guard _{m_mutex};
+            if (m_epoch != epoch)
+                co_return true;
+            waiter->position = m_waiters.insert(m_waiters.end(), waiter);
+        }
+
+        boost::system::error_code ec{};
+        co_await waiter->timer.async_wait(net::redirect_error(net::use_awaitable, ec));
+
+        std::lock_guard _{m_mutex};
+        if (!waiter->notified)
+            m_waiters.erase(waiter->position);
+        co_return waiter->notified;
+    }
+} // namespace rest
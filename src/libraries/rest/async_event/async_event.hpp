@@ -0,0 +1,67 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace rest
+{
+    /**
+     * @brief Thread-safe notification primitive for coroutines running on asio executors.
+     * @details Waiters are suspended without blocking any thread, `Notify` can be called from any thread and wakes them in order of waiting.
+     * To avoid lost notifications waiter takes an epoch before checking its condition and waits only while the epoch is unchanged.
+     */
+    class AsyncEvent
+    {
+    public:
+        AsyncEvent();
+        ~AsyncEvent();
+
+        uint64_t Epoch() const;
+
+        /**
+         * @brief Advances the epoch and wakes up to `count` longest waiting waiters, so each new item wakes a single consumer instead of all of them
+         */
+        void Notify(size_t count = std::numeric_limits<size_t>::max());
+
+        /**
+         * @brief Suspends the calling coroutine till `Notify` or `deadline`
+         * @return true if event was notified since `epoch`, false on timeout
+         */
+        boost::asio::awaitable<bool> Wait(uint64_t epoch, std::chrono::steady_clock::time_point deadline);
+
+    private:
+        struct Waiter;
+
+        boost::asio::awaitable<bool> WaitOnStrand(std::shared_ptr<Waiter> waiter, uint64_t epoch);
+
+    private:
+        mutable std::mutex                 m_mutex{};
+        uint64_t                           m_epoch{};
+        std::list<std::shared_ptr<Waiter>> m_waiters{};
+    };
+} // namespace rest
@@ -0,0 +1,86 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/use_future.hpp>
+#include <libraries/rest/async_event/async_event.hpp>
+
+#include <thread>
+
+namespace net = boost::asio;
+
+TEST_CASE("AsyncEvent wakes waiters")
+{
+    using namespace std::chrono_literals;
+
+    net::io_context  ioc{};
+    auto             work = net::make_work_guard(ioc);
+    std::thread      thread{[&ioc] { ioc.run(); }};
+    rest::AsyncEvent event{};
+
+    const auto wait = [&](uint64_t epoch, std::chrono::steady_clock::duration timeout) {
+        return net::co_spawn(ioc, event.Wait(epoch, std::chrono::steady_clock::now() + timeout), net::use_future);
+    };
+
+    SUBCASE("timeout without notification")
+    {
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(!wait(event.Epoch(), 20ms).get());
+        REQUIRE(std::chrono::steady_clock::now() - start >= 20ms);
+    }
+
+    SUBCASE("notification wakes all waiters")
+    {
+        const auto epoch  = event.Epoch();
+        auto       first  = wait(epoch, 1h);
+        auto       second = wait(epoch, 1h);
+
+        // waiters registered after notification exit immediately due to changed epoch, so order doesn't matter
+        std::this_thread::sleep_for(10ms);
+        event.Notify();
+        REQUIRE(first.get());
+        REQUIRE(second.get());
+        REQUIRE(event.Epoch() == epoch + 1);
+    }
+
+    SUBCASE("limited notification wakes the longest waiting ones")
+    {
+        const auto epoch = event.Epoch();
+        auto       first = wait(epoch, 1h);
+        std::this_thread::sleep_for(10ms);
+        auto second = wait(epoch, 100ms);
+        std::this_thread::sleep_for(10ms);
+
+        event.Notify(1);
+        REQUIRE(first.get());
+        REQUIRE(!second.get());
+        REQUIRE(event.Epoch() == epoch + 1);
+    }
+
+    SUBCASE("stale epoch returns immediately")
+    {
+        const auto epoch = event.Epoch();
+        event.Notify();
+        REQUIRE(wait(epoch, 1h).get());
+    }
+
+    work.reset();
+    thread.join();
+}
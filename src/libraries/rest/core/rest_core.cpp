@@ -28,6 +28,8 @@ namespace rest
         {
         case rest::ContentType::TextPlain: return "text/plain";
         case rest::ContentType::ApplicationJson: return "application/json";
+        case rest::ContentType::ApplicationMsgpack: return "application/msgpack";
+        case rest::ContentType::ApplicationCbor: return "application/cbor";
         }
         ENSURE_MSG(false, "Invalid content type");
     }
@@ -17,8 +17,11 @@
 
 #pragma once
 
+#include <functional>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace rest
 {
@@ -29,7 +32,9 @@ namespace rest
     enum class ContentType
     {
         TextPlain,
-        ApplicationJson
+        ApplicationJson,
+        ApplicationMsgpack,
+        ApplicationCbor
     };
 
     template<typename T>
@@ -71,12 +76,17 @@ namespace rest
             Options,
         };
 
+        // Path and body refer to the buffers of the connection, so they are valid only while request is being handled
         const NotDefaultConstructible<Method> method;
-        const std::string                     path{};
-        const std::string                     body{};
+        const std::string_view                path{};
+        const std::string_view                body{};
 
         const NotDefaultConstructible<ContentType> content_type;
         const ContentType                          accept_content_type = content_type;
+
+        // Per-request memory released at once after the response is sent. Server keeps the parsed request and the response in it,
+        // router serializes response bodies into it as well, so handler could allocate its own short-lived data there too
+        std::pmr::memory_resource* const arena = std::pmr::get_default_resource();
     };
 
     struct Response
@@ -156,9 +166,13 @@ namespace rest
         };
 
         NotDefaultConstructible<Status> status_code;
-        std::string                     body{};
+        std::pmr::string                body{}; // Allocated from `Request::arena` when produced by router
 
         NotDefaultConstructible<ContentType> content_type;
+
+        // If set, body is produced lazily and sent with chunked transfer encoding instead of `body`:
+        // every call appends the next part of the body to `chunk` and returns false after the last one
+        std::function<bool(std::string& chunk)> stream{};
     };
 
     std::string_view                 ParseContentType(rest::ContentType content_type);
@@ -0,0 +1,151 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <libraries/rest/router/rest_router.hpp>
+
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Previous implementation of the router kept as a baseline: linear scan over regex per route
+     */
+    class RegexRouter
+    {
+    public:
+        void AddRoute(const std::string& path, rest::Request::Method method, rest::Router::HandlerWithParams handler)
+        {
+            std::regex  param_regex(R"(\{\:([a-zA-Z_][a-zA-Z0-9_]*)\})");
+            std::string regex_path = std::regex_replace(path, param_regex, "([^/]+)");
+
+            auto& info   = m_routes.try_emplace(path).first->second;
+            info.pattern = std::regex("^" + regex_path + "$");
+            info.parameter_names.clear();
+            for (auto it = std::sregex_iterator(path.begin(), path.end(), param_regex); it != std::sregex_iterator(); ++it)
+                info.parameter_names.push_back((*it)[1]);
+            info.handlers[method] = std::move(handler);
+        }
+
+        rest::Response Route(const rest::Request& req) const
+        {
+            std::string          url{req.path};
+            rest::Router::Params params{};
+
+            const RouteInfo* best_route = nullptr;
+            std::smatch      best_match;
+            for (const auto& [_, route] : m_routes)
+            {
+                if (best_route && best_route->parameter_names.size() <= route.parameter_names.size())
+                    continue;
+
+                std::smatch match;
+                if (!std::regex_match(url, match, route.pattern))
+                    continue;
+
+                best_route = &route;
+                best_match = std::move(match);
+            }
+
+            if (!best_route)
+                return rest::Response{.status_code = rest::Response::Status::NotFound, .content_type = rest::ContentType::TextPlain};
+
+            for (size_t i = 0; i < best_route->parameter_names.size(); ++i)
+                params.Set(best_route->parameter_names[i], std::string_view{best_match[i + 1].first, best_match[i + 1].second});
+
+            const auto handler_it = best_route->handlers.find(req.method);
+            if (handler_it == best_route->handlers.end())
+                return rest::Response{.status_code = rest::Response::Status::MethodNotAllowed, .content_type = rest::ContentType::TextPlain};
+            return handler_it->second(req, params);
+        }
+
+    private:
+        struct RouteInfo
+        {
+            std::regex                                                                   pattern{};
+            std::vector<std::string>                                                     parameter_names{};
+            std::unordered_map<rest::Request::Method, rest::Router::HandlerWithParams> handlers{};
+        };
+
+        std::unordered_map<std::string, RouteInfo> m_routes;
+    };
+
+    // 10 resources with 5 typical routes each
+    const std::vector<std::string> resources{"users", "tasks", "projects", "teams", "organizations", "files", "comments", "tags", "queues", "workers"};
+
+    std::vector<std::pair<std::string, rest::Request::Method>> MakeRoutes()
+    {
+        std::vector<std::pair<std::string, rest::Request::Method>> routes{};
+        for (const auto& resource : resources)
+        {
+            routes.emplace_back("/api/v1/" + resource, rest::Request::Method::Get);
+            routes.emplace_back("/api/v1/" + resource + "/search", rest::Request::Method::Get);
+            routes.emplace_back("/api/v1/" + resource + "/{:id}", rest::Request::Method::Get);
+            routes.emplace_back("/api/v1/" + resource + "/{:id}/items", rest::Request::Method::Post);
+            routes.emplace_back("/api/v1/" + resource + "/{:id}/items/{:item_id}", rest::Request::Method::Delete);
+        }
+        return routes;
+    }
+
+    std::vector<std::pair<std::string, rest::Request::Method>> MakeRequests()
+    {
+        std::vector<std::pair<std::string, rest::Request::Method>> requests{};
+        for (const auto& resource : resources)
+        {
+            requests.emplace_back("/api/v1/" + resource, rest::Request::Method::Get);
+            requests.emplace_back("/api/v1/" + resource + "/search?q=text", rest::Request::Method::Get);
+            requests.emplace_back("/api/v1/" + resource + "/12345", rest::Request::Method::Get);
+            requests.emplace_back("/api/v1/" + resource + "/12345/items", rest::Request::Method::Post);
+            requests.emplace_back("/api/v1/" + resource + "/12345/items/678", rest::Request::Method::Delete);
+            requests.emplace_back("/api/v1/" + resource + "/12345/unknown", rest::Request::Method::Get);
+        }
+        return requests;
+    }
+
+    template<typename TRouter>
+    void BenchRoute(ankerl::nanobench::Bench& bench, const std::string& name, TRouter& router)
+    {
+        const auto handler = [](const rest::Request&, const rest::Router::Params& params) {
+            return rest::Response{.status_code = rest::Response::Status::Ok, .body = std::pmr::string{std::to_string(params.Size())}, .content_type = rest::ContentType::TextPlain};
+        };
+        for (const auto& [path, method] : MakeRoutes())
+            router.AddRoute(path, method, rest::Router::HandlerWithParams{handler});
+
+        const auto requests = MakeRequests();
+        bench.batch(requests.size()).run(name, [&] {
+            for (const auto& [path, method] : requests)
+                ankerl::nanobench::doNotOptimizeAway(router.Route(rest::Request{.method = method, .path = path, .content_type = rest::ContentType::ApplicationJson}));
+        });
+    }
+} // namespace
+
+TEST_CASE("Route throughput on 50 routes table")
+{
+    ankerl::nanobench::Bench bench{};
+    bench.title("Route, 50 routes").unit("request").warmup(100).relative(true);
+
+    RegexRouter regex_router{};
+    BenchRoute(bench, "regex linear scan", regex_router);
+
+    rest::Router router{};
+    BenchRoute(bench, "radix tree", router);
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace rest
+{
+    /**
+     * @brief Thrown when parameter of the request is missing or malformed, router replies with "Bad Request" then
+     */
+    class BadParameter : public std::invalid_argument
+    {
+    public:
+        using std::invalid_argument::invalid_argument;
+    };
+
+    /**
+     * @brief Inline container of path and query parameters of the request.
+     * @details Names and values are views into the route and the request, so it never allocates and is valid only while request is being handled.
+     */
+    class Params
+    {
+    public:
+        static constexpr size_t capacity = 16;
+
+        struct Entry
+        {
+            std::string_view        name{};
+            std::string_view        value{};
+            std::optional<uint64_t> number{}; // Value converted while matching typed capture (e.g. `{:id:u64}`)
+        };
+
+        /**
+         * @brief Adds new parameter or replaces value of the existing one
+         * @return false if there is no room for new parameter
+         */
+        bool Set(std::string_view name, std::string_view value, std::optional<uint64_t> number = {})
+        {
+            for (size_t i = 0; i < m_size; ++i)
+            {
+                if (m_entries[i].name == name)
+                {
+                    m_entries[i] = Entry{.name = name, .value = value, .number = number};
+                    return true;
+                }
+            }
+            if (m_size == capacity)
+                return false;
+
+            m_entries[m_size++] = Entry{.name = name, .value = value, .number = number};
+            return true;
+        }
+
+        std::optional<std::string_view> Find(std::string_view name) const
+        {
+            if (const auto* entry = FindEntry(name))
+                return entry->value;
+            return {};
+        }
+
+        /**
+         * @throws BadParameter if parameter is missing
+         */
+        std::string_view At(std::string_view name) const
+        {
+            if (const auto* entry = FindEntry(name))
+                return entry->value;
+            throw BadParameter("Missing parameter '" + std::string{name} + "'");
+        }
+
+        /**
+         * @throws BadParameter if parameter is missing or is not a valid number
+         */
+        template<std::unsigned_integral T>
+        T Get(std::string_view name) const
+        {
+            const auto* entry = FindEntry(name);
+            if (!entry)
+                throw BadParameter("Missing parameter '" + std::string{name} + "'");
+            if (entry->number && entry->number.value() <= std::numeric_limits<T>::max())
+                return static_cast<T>(entry->number.value());
+
+            T          result{};
+            const auto end       = entry->value.data() + entry->value.size();
+            const auto [ptr, ec] = std::from_chars(entry->value.data(), end, result);
+            if (ec != std::errc{} || ptr != end)
+                throw BadParameter("Invalid value of parameter '" + std::string{name} + "'");
+            return result;
+        }
+
+        template<std::unsigned_integral T>
+        T Get(std::string_view name, T default_value) const
+        {
+            return FindEntry(name) ? Get<T>(name) : default_value;
+        }
+
+        size_t Size() const { return m_size; }
+
+        const Entry* begin() const { return m_entries.data(); }
+        const Entry* end() const { return m_entries.data() + m_size; }
+
+    private:
+        const Entry* FindEntry(std::string_view name) const
+        {
+            for (size_t i = 0; i < m_size; ++i)
+                if (m_entries[i].name == name)
+                    return &m_entries[i];
+            return nullptr;
+        }
+
+    private:
+        std::array<Entry, capacity> m_entries{};
+        size_t                      m_size{};
+    };
+} // namespace rest
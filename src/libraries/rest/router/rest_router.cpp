@@ -17,95 +17,251 @@
 
 #include "rest_router.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
 namespace rest
 {
     namespace
     {
-        std::unordered_map<std::string, std::string> ParseParams(std::string& url)
+        /**
+         * @brief Parses query params into `params` and strips them from the `url`
+         * @return false if there are too many params
+         */
+        bool ParseParams(std::string_view& url, Params& params)
         {
             size_t query_start = url.find('?');
-            if (query_start == std::string::npos)
-                return {};
+            if (query_start == std::string_view::npos)
+                return true;
 
-            auto query = std::string_view{url}.substr(query_start + 1);
+            auto query = url.substr(query_start + 1);
+            url        = url.substr(0, query_start);
 
-            std::unordered_map<std::string, std::string> query_params;
-            size_t                                       start = 0;
+            size_t start = 0;
             while (true)
             {
                 auto end   = query.find('&', start);
-                auto param = query.substr(start, end == std::string::npos ? end : end - start);
+                auto param = query.substr(start, end == std::string_view::npos ? end : end - start);
                 auto eq    = param.find('=');
 
-                query_params[std::string{param.substr(0, eq)}] = eq != std::string::npos ? param.substr(eq + 1) : "";
+                if (!params.Set(param.substr(0, eq), eq != std::string_view::npos ? param.substr(eq + 1) : ""))
+                    return false;
 
-                if (end == std::string::npos)
-                    break;
+                if (end == std::string_view::npos)
+                    return true;
 
                 start = end + 1;
             }
+        }
 
-            url.resize(query_start);
+        /**
+         * @brief Splits off the first segment of the path, rest is empty optional for the last segment
+         */
+        std::pair<std::string_view, std::optional<std::string_view>> SplitSegment(std::string_view path)
+        {
+            const auto end = path.find('/');
+            if (end == std::string_view::npos)
+                return {path, std::nullopt};
+            return {path.substr(0, end), path.substr(end + 1)};
+        }
+
+        std::optional<std::pair<std::string_view, std::string_view>> ParseParameter(std::string_view segment)
+        {
+            if (!segment.starts_with("{:") || !segment.ends_with('}'))
+            {
+                if (segment.find("{:") != std::string_view::npos)
+                    throw std::invalid_argument("Parameter should occupy the whole path segment");
+                return {};
+            }
 
-            return query_params;
+            const auto parameter = segment.substr(2, segment.size() - 3);
+            const auto colon     = parameter.find(':');
+            const auto name      = parameter.substr(0, colon);
+            if (name.empty() || std::isdigit(static_cast<unsigned char>(name.front())) || !std::ranges::all_of(name, [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }))
+                throw std::invalid_argument("Invalid parameter name: " + std::string{name});
+            return std::pair{name, colon == std::string_view::npos ? std::string_view{} : parameter.substr(colon + 1)};
         }
     } // namespace
-    void Router::AddRouteImpl(const std::string& path, Request::Method method, Router::HandlerWithParams handler)
+
+    void Router::AddRouteImpl(const std::string& path, Request::Method method, Router::Handler handler)
     {
         if (path.empty() || path[0] != '/')
             throw std::invalid_argument("Path must start with '/'");
 
-        if (!handler)
+        if (std::visit([](const auto& h) { return !h; }, handler))
             throw std::invalid_argument("Handler cannot be null");
 
-        // Replace {:name} with regex group `([^/]+)` and extract parameter names
-        std::regex  param_regex(R"(\{\:([a-zA-Z_][a-zA-Z0-9_]*)\})");
-        std::string regex_path = std::regex_replace(path, param_regex, "([^/]+)");
-        std::regex  full_regex("^" + regex_path + "$"); // Ensure full match
-
-        std::vector<std::string> parameter_names;
-        auto                     begin = std::sregex_iterator(path.begin(), path.end(), param_regex);
-        auto                     end   = std::sregex_iterator();
-        for (auto it = begin; it != end; ++it)
-            parameter_names.push_back((*it)[1]);
-
-        auto& info            = m_routes.try_emplace(path).first->second;
-        info.pattern          = full_regex;
-        info.parameter_names  = parameter_names;
-        info.handlers[method] = std::move(handler);
+        size_t                 node_index = 0;
+        std::vector<Parameter> parameters{};
+        for (std::optional<std::string_view> rest = std::string_view{path}.substr(1); rest;)
+        {
+            const auto [segment, next] = SplitSegment(rest.value());
+            rest                       = next;
+
+            const auto parameter = ParseParameter(segment);
+            if (parameter)
+            {
+                const auto& [name, type] = parameter.value();
+                if (!type.empty() && type != "u64")
+                    throw std::invalid_argument("Unsupported parameter type: " + std::string{type});
+                parameters.push_back(Parameter{.name = std::string{name}, .type = type.empty() ? Parameter::Type::String : Parameter::Type::U64});
+            }
+
+            auto& node  = m_nodes[node_index];
+            auto  child = parameter ? node.parameter_child : std::optional<size_t>{};
+            if (const auto itr = node.static_children.find(segment); !parameter && itr != node.static_children.end())
+                child = itr->second;
+
+            if (!child)
+            {
+                child = m_nodes.size();
+                if (parameter)
+                    node.parameter_child = child;
+                else
+                    node.static_children.emplace(segment, child.value());
+                // Invalidates `node`, so it goes last
+                m_nodes.emplace_back();
+            }
+            node_index = child.value();
+        }
+
+        if (parameters.size() > Params::capacity)
+            throw std::invalid_argument("Too many parameters in path");
+
+        auto& node                                 = m_nodes[node_index];
+        node.parameters                            = std::move(parameters);
+        node.handlers[static_cast<size_t>(method)] = std::move(handler);
+        node.has_handlers                          = true;
     }
 
-    Response Router::Route(const Request& req) const
+    const Router::Node* Router::Match(const Node& node, std::optional<std::string_view> path, Captures& captures, size_t captures_count) const
     {
-        std::string url    = req.path;
-        Params      params = ParseParams(url);
-        for (const auto& [_, route] : m_routes)
+        if (!path)
+            return node.has_handlers ? &node : nullptr;
+
+        const auto [segment, rest] = SplitSegment(path.value());
+        if (const auto itr = node.static_children.find(segment); itr != node.static_children.end())
+        {
+            if (const auto* result = Match(m_nodes[itr->second], rest, captures, captures_count))
+                return result;
+        }
+
+        if (node.parameter_child && !segment.empty() && captures_count < captures.size())
         {
-            std::smatch match;
-            if (!std::regex_match(url, match, route.pattern))
-                continue;
+            captures[captures_count] = segment;
+            if (const auto* result = Match(m_nodes[node.parameter_child.value()], rest, captures, captures_count + 1))
+                return result;
+        }
+        return nullptr;
+    }
 
-            if (match.size() != route.parameter_names.size() + 1)
-                return Response{.status_code = Response::Status::InternalServerError, .body = "Internal server error", .content_type = ContentType::TextPlain};
+    std::variant<const Router::Handler*, Response> Router::FindHandler(const Request& req, Params& params) const
+    {
+        std::string_view url = req.path;
+        if (!ParseParams(url, params))
+            return TextResponse(req, Response::Status::BadRequest, "Too many parameters");
 
-            for (size_t i = 0; i < route.parameter_names.size(); ++i)
-                params[route.parameter_names[i]] = match[i + 1]; // First group is at index 1
+        if (url.empty() || url[0] != '/')
+            return TextResponse(req, Response::Status::NotFound);
 
-            // Find and call the handler
-            auto handler_it = route.handlers.find(req.method);
-            if (handler_it == route.handlers.end())
-                return Response{.status_code = Response::Status::MethodNotAllowed, .content_type = ContentType::TextPlain};
+        Captures    captures{};
+        const auto* node = Match(m_nodes.front(), url.substr(1), captures, 0);
+        if (!node)
+            return TextResponse(req, Response::Status::NotFound);
 
-            try
-            {
-                return handler_it->second(req, params);
-            }
-            catch (const std::exception& e)
+        for (size_t i = 0; i < node->parameters.size(); ++i)
+        {
+            const auto&             parameter = node->parameters[i];
+            const auto              value     = captures[i];
+            std::optional<uint64_t> number{};
+            if (parameter.type == Parameter::Type::U64)
             {
-                return Response{.status_code = Response::Status::InternalServerError, .body = e.what(), .content_type = ContentType::TextPlain};
+                const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), number.emplace());
+                if (ec != std::errc{} || ptr != value.data() + value.size())
+                    return TextResponse(req, Response::Status::BadRequest, "Invalid value of parameter '" + parameter.name + "'");
             }
+
+            if (!params.Set(parameter.name, value, number))
+                return TextResponse(req, Response::Status::BadRequest, "Too many parameters");
+        }
+
+        const auto& handler = node->handlers[static_cast<size_t>(req.method.get())];
+        if (!handler)
+            return TextResponse(req, Response::Status::MethodNotAllowed);
+
+        return &handler.value();
+    }
+
+    Response Router::TextResponse(const Request& req, Response::Status status, std::string_view text)
+    {
+        return Response{.status_code = status, .body = std::pmr::string{text, req.arena}, .content_type = ContentType::TextPlain};
+    }
+
+    Response Router::Invoke(const HandlerWithParams& handler, const Request& req, const Params& params)
+    {
+        try
+        {
+            return handler(req, params);
+        }
+        catch (const BadParameter& e)
+        {
+            return TextResponse(req, Response::Status::BadRequest, e.what());
+        }
+        catch (const std::exception& e)
+        {
+            return TextResponse(req, Response::Status::InternalServerError, e.what());
+        }
+    }
+
+    boost::asio::awaitable<Response> Router::Await(const AsyncHandlerWithParams& handler, const Request& req, Params params)
+    {
+        try
+        {
+            co_return co_await handler(req, params);
+        }
+        catch (const BadParameter& e)
+        {
+            co_return TextResponse(req, Response::Status::BadRequest, e.what());
+        }
+        catch (const std::exception& e)
+        {
+            co_return TextResponse(req, Response::Status::InternalServerError, e.what());
         }
-        return Response{.status_code = Response::Status::NotFound, .content_type = ContentType::TextPlain};
+    }
+
+    Response Router::Route(const Request& req) const
+    {
+        Params params{};
+        auto   found = FindHandler(req, params);
+        if (auto* response = std::get_if<Response>(&found))
+            return std::move(*response);
+
+        const auto* handler = std::get_if<HandlerWithParams>(std::get<const Handler*>(found));
+        if (!handler)
+            return TextResponse(req, Response::Status::InternalServerError, "Asynchronous handler can't be routed synchronously");
+        return Invoke(*handler, req, params);
+    }
+
+    boost::asio::awaitable<Response> Router::RouteAsync(const Request& req) const
+    {
+        auto dispatched = Dispatch(req);
+        if (auto* response = std::get_if<Response>(&dispatched))
+            co_return std::move(*response);
+        co_return co_await std::get<boost::asio::awaitable<Response>>(std::move(dispatched));
+    }
+
+    std::variant<Response, boost::asio::awaitable<Response>> Router::Dispatch(const Request& req) const
+    {
+        Params params{};
+        auto   found = FindHandler(req, params);
+        if (auto* response = std::get_if<Response>(&found))
+            return std::move(*response);
+
+        const auto& handler = *std::get<const Handler*>(found);
+        if (const auto* async_handler = std::get_if<AsyncHandlerWithParams>(&handler))
+            return Await(*async_handler, req, params);
+        return Invoke(std::get<HandlerWithParams>(handler), req, params);
     }
 
 } // namespace rest
@@ -17,24 +17,90 @@
 
 #pragma once
 
+#include <boost/asio/awaitable.hpp>
 #include <libraries/rest/core/rest_core.hpp>
+#include <libraries/rest/router/rest_params.hpp>
 #include <libraries/utils/function_traits.hpp>
 #include <libraries/utils/utils.hpp>
+#include <rfl/cbor.hpp>
 #include <rfl/json.hpp>
+#include <rfl/msgpack.hpp>
 
-#include <regex>
-#include <unordered_map>
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace rest
 {
-    template<typename T>
-    std::string Serialize(const T& v, rest::ContentType content_type)
+    namespace details
+    {
+        /**
+         * @brief Stream buffer appending everything written to it to the string, so serializer writes straight into the destination
+         */
+        template<typename String>
+        class AppendBuffer : public std::streambuf
+        {
+        public:
+            explicit AppendBuffer(String& out)
+                : m_out{out}
+            {
+            }
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    m_out.push_back(traits_type::to_char_type(c));
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char* data, std::streamsize size) override
+            {
+                m_out.append(data, static_cast<size_t>(size));
+                return size;
+            }
+
+        private:
+            String& m_out;
+        };
+    } // namespace details
+
+    /**
+     * @brief Appends serialized `v` to `out`, so the caller decides where it lives (e.g. in the arena of the request)
+     */
+    template<typename T, typename String>
+    void SerializeTo(const T& v, rest::ContentType content_type, String& out)
     {
         switch (content_type)
         {
         case rest::ContentType::ApplicationJson:
-            return rfl::json::write(v);
+        {
+            details::AppendBuffer<String> buffer{out};
+            std::ostream                  stream{&buffer};
+            rfl::json::write(v, stream);
+            return;
+        }
+        case rest::ContentType::ApplicationMsgpack:
+        {
+            const auto bytes = rfl::msgpack::write(v);
+            out.append(bytes.data(), bytes.size());
+            return;
+        }
+        case rest::ContentType::ApplicationCbor:
+        {
+            const auto bytes = rfl::cbor::write(v);
+            out.append(bytes.data(), bytes.size());
+            return;
+        }
         case rest::ContentType::TextPlain:
             throw std::runtime_error("Unsupported accept content type");
         }
@@ -42,12 +108,24 @@ namespace rest
     }
 
     template<typename T>
-    T DeSerialize(const std::string& v, rest::ContentType content_type)
+    std::string Serialize(const T& v, rest::ContentType content_type)
+    {
+        std::string result{};
+        SerializeTo(v, content_type, result);
+        return result;
+    }
+
+    template<typename T>
+    T DeSerialize(std::string_view v, rest::ContentType content_type)
     {
         switch (content_type)
         {
         case rest::ContentType::ApplicationJson:
             return rfl::json::read<T>(v).value();
+        case rest::ContentType::ApplicationMsgpack:
+            return rfl::msgpack::read<T>(v.data(), v.size()).value();
+        case rest::ContentType::ApplicationCbor:
+            return rfl::cbor::read<T>(v.data(), v.size()).value();
         case rest::ContentType::TextPlain:
             throw std::runtime_error("Unsupported request content type");
         }
@@ -60,11 +138,63 @@ namespace rest
     template<typename T>
     concept Deserializable = requires(const T& v) { DeSerialize<T>("", {}); };
 
+    /**
+     * @brief Sequence of items which is serialized lazily as an array and sent with chunked transfer encoding, so the whole body is never materialized
+     * @details Items are pulled while the response is being written, i.e. after the handler has returned, so the source is owned by the stream
+     */
+    template<Serializable T>
+    class Stream
+    {
+    public:
+        using Generator = std::function<std::optional<T>()>;
+
+        /**
+         * @param generator returns next item, empty optional marks the end of the stream
+         */
+        explicit Stream(Generator generator)
+            : m_generator{std::move(generator)}
+        {
+        }
+
+        template<std::ranges::input_range Range>
+            requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+        explicit Stream(Range range)
+            : m_generator{FromRange(std::move(range))}
+        {
+        }
+
+        std::optional<T> Next() const { return m_generator(); }
+
+    private:
+        template<typename Range>
+        static Generator FromRange(Range range)
+        {
+            struct State
+            {
+                Range                                         range;
+                std::optional<std::ranges::iterator_t<Range>> itr{};
+            };
+
+            // Iterator is taken once range is placed into its final storage
+            return [state = std::make_shared<State>(State{.range = std::move(range)})]() -> std::optional<T> {
+                if (!state->itr)
+                    state->itr = std::ranges::begin(state->range);
+                if (state->itr.value() == std::ranges::end(state->range))
+                    return {};
+                return T(*state->itr.value()++);
+            };
+        }
+
+    private:
+        Generator m_generator;
+    };
+
     class Router
     {
     public:
-        using Params            = std::unordered_map<std::string, std::string>;
-        using HandlerWithParams = std::function<Response(const Request&, const Params&)>;
+        using Params                 = rest::Params;
+        using HandlerWithParams      = std::function<Response(const Request&, const Params&)>;
+        using AsyncHandlerWithParams = std::function<boost::asio::awaitable<Response>(const Request&, const Params&)>;
 
         template<Serializable T>
         struct SerializableResponse
@@ -73,56 +203,88 @@ namespace rest
             const NotDefaultConstructible<T>                body;
         };
 
+        // Streamed body is sent in chunks of about this size
+        static constexpr size_t stream_chunk_size = 16 * 1024;
+
         Router() = default;
 
         /**
          * @brief Adds a new route to the router
-         * @param path The URL path pattern (e.g., "/users/{:id}")
+         * @details Handler could return either value or `boost::asio::awaitable` of it, the last one is awaited without blocking the thread.
+         * `Stream` of items is sent as JSON or CBOR array with chunked transfer encoding.
+         * @param path The URL path pattern (e.g., "/users/{:id}" or "/users/{:id:u64}" for validated number), parameter should occupy the whole segment
          * @param method The HTTP method to handle
          * @param handler The callback to handle matching requests
-         * @throws std::regex_error If the path pattern is invalid
+         * @throws std::invalid_argument If the path pattern is invalid
          */
         template<std::invocable<utils::ConvertibleToAny, Params> THandler>
         void AddRoute(const std::string& path, Request::Method method, THandler&& handler)
         {
-            using Traits        = typename utils::FunctionTraits<THandler>;
+            using Traits        = typename utils::FunctionTraits<std::decay_t<THandler>>;
             using FirstArgument = std::decay_t<typename Traits::template argument<0>>;
             using Result        = std::decay_t<typename Traits::result>;
-            if constexpr (std::same_as<FirstArgument, Request>)
+            if constexpr (std::same_as<FirstArgument, Request> && std::same_as<Result, boost::asio::awaitable<Response>>)
+            {
+                return AddRouteImpl(path, method, AsyncHandlerWithParams{std::forward<THandler>(handler)});
+            }
+            else if constexpr (std::same_as<FirstArgument, Request>)
             {
                 static_assert(std::same_as<Response, Result>);
-                return AddRouteImpl(path, method, std::forward<THandler>(handler));
+                return AddRouteImpl(path, method, HandlerWithParams{std::forward<THandler>(handler)});
+            }
+            else if constexpr (utils::IsBaseOf<Result, boost::asio::awaitable>)
+            {
+                static_assert(Deserializable<FirstArgument>);
+                using AwaitedResult = typename Result::value_type;
+                if constexpr (utils::IsBaseOf<AwaitedResult, Stream>)
+                {
+                    return AddRoute(path, method, [handler = std::forward<THandler>(handler)](const Request& req, const Params& params) -> boost::asio::awaitable<Response> {
+                        auto body = DeSerializeBody<FirstArgument>(req);
+                        if (auto* error = std::get_if<Response>(&body))
+                            co_return std::move(*error);
+
+                        co_return StreamResponse(co_await handler(std::get<FirstArgument>(body), params), req);
+                    });
+                }
+                else if constexpr (utils::IsBaseOf<AwaitedResult, SerializableResponse>)
+                {
+                    return AddRoute(path, method, [handler = std::forward<THandler>(handler)](const Request& req, const Params& params) -> boost::asio::awaitable<Response> {
+                        auto body = DeSerializeBody<FirstArgument>(req);
+                        if (auto* error = std::get_if<Response>(&body))
+                            co_return std::move(*error);
+
+                        co_return SerializeResponse(co_await handler(std::get<FirstArgument>(body), params), req);
+                    });
+                }
+                else
+                {
+                    static_assert(Serializable<AwaitedResult>);
+                    return AddRoute(path, method, [handler = std::forward<THandler>(handler)](const FirstArgument& req, const Params& params) -> boost::asio::awaitable<SerializableResponse<AwaitedResult>> {
+                        co_return SerializableResponse<AwaitedResult>{.status_code = rest::Response::Status::Ok, .body = co_await handler(req, params)};
+                    });
+                }
             }
             else
             {
                 static_assert(Deserializable<FirstArgument>);
-                if constexpr (utils::IsBaseOf<Result, SerializableResponse>)
+                if constexpr (utils::IsBaseOf<Result, Stream>)
+                {
+                    return AddRoute(path, method, [handler = std::forward<THandler>(handler)](const Request& req, const Params& params) {
+                        auto body = DeSerializeBody<FirstArgument>(req);
+                        if (auto* error = std::get_if<Response>(&body))
+                            return std::move(*error);
+
+                        return StreamResponse(handler(std::get<FirstArgument>(body), params), req);
+                    });
+                }
+                else if constexpr (utils::IsBaseOf<Result, SerializableResponse>)
                 {
                     return AddRoute(path, method, [handler = std::forward<THandler>(handler)](const Request& req, const Params& params) {
-                        std::optional<FirstArgument> body{};
-                        try
-                        {
-                            if constexpr (std::same_as<FirstArgument, None>)
-                                body.emplace();
-                            else
-                                body = DeSerialize<FirstArgument>(req.body, req.content_type);
-                        }
-                        catch (const std::exception& e)
-                        {
-                            return Response{.status_code = Response::Status::BadRequest, .body = e.what(), .content_type = ContentType::TextPlain};
-                        }
-
-                        const auto  res = handler(body.value(), params);
-                        std::string body_str{};
-                        try
-                        {
-                            body_str = Serialize(res.body.get(), req.accept_content_type);
-                        }
-                        catch (const std::exception& e)
-                        {
-                            return Response{.status_code = Response::Status::BadRequest, .body = e.what(), .content_type = ContentType::TextPlain};
-                        }
-                        return Response{.status_code = res.status_code, .body = std::move(body_str), .content_type = req.accept_content_type};
+                        auto body = DeSerializeBody<FirstArgument>(req);
+                        if (auto* error = std::get_if<Response>(&body))
+                            return std::move(*error);
+
+                        return SerializeResponse(handler(std::get<FirstArgument>(body), params), req);
                     });
                 }
                 else
@@ -142,16 +304,163 @@ namespace rest
          */
         [[nodiscard]] Response Route(const Request& req) const;
 
+        /**
+         * @brief Routes an incoming request to the appropriate handler, asynchronous handlers are awaited without blocking the thread
+         * @param req The incoming HTTP request, must outlive the returned awaitable
+         * @return HTTP response from the matching handler
+         */
+        [[nodiscard]] boost::asio::awaitable<Response> RouteAsync(const Request& req) const;
+
+        /**
+         * @brief Routes an incoming request to the appropriate handler: synchronous one is invoked in place, so only asynchronous handlers cost a coroutine frame
+         * @param req The incoming HTTP request, must outlive the returned awaitable
+         * @return HTTP response of synchronous handler or routing error, otherwise awaitable of the asynchronous handler's response
+         */
+        [[nodiscard]] std::variant<Response, boost::asio::awaitable<Response>> Dispatch(const Request& req) const;
+
+        /**
+         * @return plain text response with body allocated from the arena of the request
+         */
+        static Response TextResponse(const Request& req, Response::Status status, std::string_view text = {});
+
     private:
-        void AddRouteImpl(const std::string& path, Request::Method method, std::function<Response(const Request&, const Params&)> handler);
+        using Handler = std::variant<HandlerWithParams, AsyncHandlerWithParams>;
 
-        struct RouteInfo
+        /**
+         * @return deserialized body of the request, otherwise response with error
+         */
+        template<Deserializable T>
+        static std::variant<T, Response> DeSerializeBody(const Request& req)
         {
-            std::regex                                             pattern{};
-            std::vector<std::string>                               parameter_names{}; // List of parameter names
-            std::unordered_map<Request::Method, HandlerWithParams> handlers{};
+            try
+            {
+                if constexpr (std::same_as<T, None>)
+                    return None{};
+                else
+                    return DeSerialize<T>(req.body, req.content_type);
+            }
+            catch (const std::exception& e)
+            {
+                return TextResponse(req, Response::Status::BadRequest, e.what());
+            }
+        }
+
+        template<Serializable T>
+        static Response SerializeResponse(const SerializableResponse<T>& res, const Request& req)
+        {
+            try
+            {
+                std::pmr::string body{req.arena};
+                SerializeTo(res.body.get(), req.accept_content_type, body);
+                return Response{.status_code = res.status_code, .body = std::move(body), .content_type = req.accept_content_type};
+            }
+            catch (const std::exception& e)
+            {
+                return TextResponse(req, Response::Status::BadRequest, e.what());
+            }
+        }
+
+        /**
+         * @brief Delimiters of array with unknown in advance count of items
+         */
+        struct StreamFraming
+        {
+            std::string_view open;
+            std::string_view separator;
+            std::string_view close;
         };
 
-        std::unordered_map<std::string, RouteInfo> m_routes;
+        static std::optional<StreamFraming> GetStreamFraming(ContentType content_type)
+        {
+            switch (content_type)
+            {
+            case ContentType::ApplicationJson: return StreamFraming{.open = "[", .separator = ",", .close = "]"};
+            // Indefinite-length array: items are concatenated till the "break" byte
+            case ContentType::ApplicationCbor: return StreamFraming{.open = "\x9f", .separator = "", .close = "\xff"};
+            // MessagePack array requires count of items upfront
+            case ContentType::ApplicationMsgpack:
+            case ContentType::TextPlain: return {};
+            }
+            ENSURE_MSG(false, "Invalid content type");
+        }
+
+        template<Serializable T>
+        static Response StreamResponse(Stream<T> stream, const Request& req)
+        {
+            // Errors are reported before the headers are sent, items are serialized only when the server writes the body
+            const auto framing = GetStreamFraming(req.accept_content_type);
+            if (!framing)
+                return TextResponse(req, Response::Status::BadRequest, "Unsupported accept content type");
+
+            auto writer = [stream = std::move(stream), framing = framing.value(), content_type = req.accept_content_type, empty = true](std::string& chunk) mutable {
+                if (empty)
+                    chunk += framing.open;
+                while (chunk.size() < stream_chunk_size)
+                {
+                    auto item = stream.Next();
+                    if (!item)
+                    {
+                        chunk += framing.close;
+                        return false;
+                    }
+                    if (!std::exchange(empty, false))
+                        chunk += framing.separator;
+                    SerializeTo(item.value(), content_type, chunk);
+                }
+                return true;
+            };
+            return Response{.status_code = Response::Status::Ok, .content_type = req.accept_content_type, .stream = std::move(writer)};
+        }
+
+        void AddRouteImpl(const std::string& path, Request::Method method, Handler handler);
+
+        /**
+         * @return handler for the request and fills its params, otherwise response with routing error
+         */
+        std::variant<const Handler*, Response> FindHandler(const Request& req, Params& params) const;
+
+        static Response Invoke(const HandlerWithParams& handler, const Request& req, const Params& params);
+
+        /**
+         * @brief Params are kept in the coroutine frame, as the handler refers to them till it completes
+         */
+        static boost::asio::awaitable<Response> Await(const AsyncHandlerWithParams& handler, const Request& req, Params params);
+
+        static constexpr size_t methods_count = static_cast<size_t>(Request::Method::Options) + 1;
+
+        struct Parameter
+        {
+            enum class Type
+            {
+                String,
+                U64,
+            };
+
+            std::string name{};
+            Type        type{};
+        };
+
+        /**
+         * @brief Node of the radix tree, every node corresponds to one segment of the path
+         */
+        struct Node
+        {
+            std::map<std::string, size_t, std::less<>>        static_children{};
+            std::optional<size_t>                             parameter_child{};
+            std::vector<Parameter>                            parameters{}; // All parameters of the route ending at this node
+            std::array<std::optional<Handler>, methods_count> handlers{};
+            bool                                              has_handlers{};
+        };
+
+        using Captures = std::array<std::string_view, Params::capacity>;
+
+        /**
+         * @brief Static segments take precedence over parameters, so "/tasks/dequeue" is preferred over "/tasks/{:id}"
+         * @param path rest of the path without leading slash, empty optional if every segment is matched already
+         */
+        const Node* Match(const Node& node, std::optional<std::string_view> path, Captures& captures, size_t captures_count) const;
+
+        // Nodes are stored in a flat array and refer to each other by index, root is the first one
+        std::vector<Node> m_nodes = std::vector<Node>(1);
     };
 } // namespace rest
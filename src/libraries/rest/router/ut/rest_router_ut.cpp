@@ -17,8 +17,14 @@
 
 #include <doctest/doctest.h>
 
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
 #include <libraries/rest/router/rest_router.hpp>
 
+#include <memory_resource>
+#include <variant>
+
 struct SerializableData
 {
     int                      data{};
@@ -27,6 +33,18 @@ struct SerializableData
     auto operator<=>(const SerializableData& rhs) const = default;
 };
 
+namespace
+{
+    rest::Response RouteAsync(const rest::Router& router, const rest::Request& request)
+    {
+        boost::asio::io_context       ioc{};
+        std::optional<rest::Response> result{};
+        boost::asio::co_spawn(ioc, [&]() -> boost::asio::awaitable<void> { result.emplace(co_await router.RouteAsync(request)); }, boost::asio::detached);
+        ioc.run();
+        return result.value();
+    }
+} // namespace
+
 TEST_CASE("Router provide correct routing")
 {
     rest::Router router{};
@@ -76,19 +94,130 @@ TEST_CASE("Router provide correct routing")
         router.AddRoute("/test", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) -> rest::Response { throw std::runtime_error("test"); });
         REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::InternalServerError);
     }
+    SUBCASE("asynchronous handler")
+    {
+        router.AddRoute("/test/{:id}", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) -> boost::asio::awaitable<rest::Response> {
+            co_return rest::Response{.status_code = rest::Response::Status::Ok, .body = std::pmr::string{params.At("id")}, .content_type = rest::ContentType::TextPlain};
+        });
+        router.AddRoute("/test/{:id}", rest::Request::Method::Post, [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Created, .content_type = rest::ContentType::TextPlain}; });
+
+        const auto route_async = [&router](rest::Request::Method method) {
+            return RouteAsync(router, rest::Request{.method = method, .path = "/test/12", .content_type = rest::ContentType::TextPlain});
+        };
+
+        const auto res = route_async(rest::Request::Method::Get);
+        REQUIRE(res.status_code == rest::Response::Status::Ok);
+        REQUIRE(res.body == "12");
+        REQUIRE(route_async(rest::Request::Method::Post).status_code == rest::Response::Status::Created);
+        REQUIRE(route_async(rest::Request::Method::Delete).status_code == rest::Response::Status::MethodNotAllowed);
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/12", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::InternalServerError);
+    }
+    SUBCASE("streamed response")
+    {
+        const auto drain = [](const rest::Response& res) {
+            std::vector<std::string> chunks{};
+            for (bool more = true; more;)
+                more = res.stream(chunks.emplace_back());
+            return chunks;
+        };
+        const auto join = [](const std::vector<std::string>& chunks) {
+            std::string result{};
+            for (const auto& chunk : chunks)
+                result += chunk;
+            return result;
+        };
+
+        const auto items = std::vector<SerializableData>(10'000, SerializableData{.data = 30, .texts = {"hello", "world"}});
+        const auto get   = rest::Request{.method = rest::Request::Method::Get, .path = "/test", .content_type = rest::ContentType::ApplicationJson};
+
+        SUBCASE("from range")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [&items](const rest::None&, const rest::Router::Params&) { return rest::Stream<SerializableData>{items}; });
+
+            const auto res = router.Route(get);
+            REQUIRE(res.status_code == rest::Response::Status::Ok);
+            REQUIRE(res.stream);
+
+            const auto chunks = drain(res);
+            REQUIRE(chunks.size() > 1);
+            for (const auto& chunk : chunks)
+                CHECK(chunk.size() < rest::Router::stream_chunk_size + 100);
+            CHECK(join(chunks) == rest::Serialize(items, rest::ContentType::ApplicationJson));
+        }
+        SUBCASE("from generator asynchronously")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [](const rest::None&, const rest::Router::Params&) -> boost::asio::awaitable<rest::Stream<int>> {
+                co_return rest::Stream<int>{[i = 0]() mutable -> std::optional<int> { return i < 3 ? std::optional{i++} : std::nullopt; }};
+            });
+
+            CHECK(join(drain(RouteAsync(router, get))) == "[0,1,2]");
+        }
+        SUBCASE("empty stream")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [](const rest::None&, const rest::Router::Params&) { return rest::Stream<int>{std::vector<int>{}}; });
+
+            CHECK(join(drain(router.Route(get))) == "[]");
+        }
+        SUBCASE("as CBOR indefinite-length array")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [](const rest::None&, const rest::Router::Params&) { return rest::Stream<int>{std::vector{1, 2}}; });
+
+            const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .content_type = rest::ContentType::ApplicationJson, .accept_content_type = rest::ContentType::ApplicationCbor});
+            CHECK(res.content_type == rest::ContentType::ApplicationCbor);
+            CHECK(join(drain(res)) == "\x9f" + rest::Serialize(1, rest::ContentType::ApplicationCbor) + rest::Serialize(2, rest::ContentType::ApplicationCbor) + "\xff");
+        }
+        SUBCASE("unsupported accept content type")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [](const rest::None&, const rest::Router::Params&) { return rest::Stream<int>{std::vector<int>{}}; });
+
+            const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .content_type = rest::ContentType::ApplicationJson, .accept_content_type = rest::ContentType::TextPlain});
+            CHECK(res.status_code == rest::Response::Status::BadRequest);
+            CHECK(!res.stream);
+        }
+    }
     SUBCASE("pattern with parameter")
     {
         router.AddRoute("/test/{:id}/subtest", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) {
-            REQUIRE(params.at("id") == "135");
+            REQUIRE(params.At("id") == "135");
             return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain};
         });
         REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/135/subtest", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Ok);
         REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/135", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::NotFound);
     }
+    SUBCASE("static route takes precedence over pattern")
+    {
+        router.AddRoute("/test/{:id}", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain}; });
+        router.AddRoute("/test/static", rest::Request::Method::Post, [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Created, .content_type = rest::ContentType::TextPlain}; });
+
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Post, .path = "/test/static", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Created);
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/static", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::MethodNotAllowed);
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/12", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Ok);
+    }
+    SUBCASE("pattern is used when static route doesn't match the rest of the path")
+    {
+        router.AddRoute("/test/{:id}/sub", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) {
+            REQUIRE(params.At("id") == "static");
+            return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain};
+        });
+        router.AddRoute("/test/static/other", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Created, .content_type = rest::ContentType::TextPlain}; });
+
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/static/sub", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Ok);
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/static/other", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Created);
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test//sub", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::NotFound);
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/static/sub/", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::NotFound);
+    }
+    SUBCASE("invalid patterns")
+    {
+        const auto handler = [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain}; };
+        REQUIRE_THROWS_AS(router.AddRoute("test", rest::Request::Method::Get, handler), std::invalid_argument);
+        REQUIRE_THROWS_AS(router.AddRoute("/test/id{:id}", rest::Request::Method::Get, handler), std::invalid_argument);
+        REQUIRE_THROWS_AS(router.AddRoute("/test/{:1id}", rest::Request::Method::Get, handler), std::invalid_argument);
+        REQUIRE_THROWS_AS(router.AddRoute("/test/{:}", rest::Request::Method::Get, handler), std::invalid_argument);
+    }
     SUBCASE("query params")
     {
         router.AddRoute("/test/", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) {
-            REQUIRE(params.at("key") == "value");
+            REQUIRE(params.At("key") == "value");
             return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain};
         });
         REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/?key=value", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Ok);
@@ -96,13 +225,55 @@ TEST_CASE("Router provide correct routing")
     SUBCASE("query params and path params")
     {
         router.AddRoute("/test/{:id}/subtest", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) {
-            REQUIRE(params.at("key") == "value");
-            REQUIRE(params.at("key2") == "value2");
-            REQUIRE(params.at("id") == "23");
+            REQUIRE(params.At("key") == "value");
+            REQUIRE(params.At("key2") == "value2");
+            REQUIRE(params.At("id") == "23");
             return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain};
         });
         REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/23/subtest?key=value&key2=value2", .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::Ok);
     }
+    SUBCASE("typed path params")
+    {
+        router.AddRoute("/test/{:id:u64}", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) {
+            return rest::Response{.status_code = rest::Response::Status::Ok, .body = std::pmr::string{std::to_string(params.Get<uint64_t>("id") + 1)}, .content_type = rest::ContentType::TextPlain};
+        });
+
+        const auto ok = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test/41", .content_type = rest::ContentType::TextPlain});
+        REQUIRE(ok.status_code == rest::Response::Status::Ok);
+        REQUIRE(ok.body == "42");
+
+        for (const auto* path : {"/test/abc", "/test/-1", "/test/1a", "/test/99999999999999999999"})
+        {
+            const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = path, .content_type = rest::ContentType::TextPlain});
+            REQUIRE(res.status_code == rest::Response::Status::BadRequest);
+            REQUIRE(res.body == "Invalid value of parameter 'id'");
+        }
+
+        REQUIRE_THROWS_AS(router.AddRoute("/other/{:id:i32}", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain}; }), std::invalid_argument);
+    }
+    SUBCASE("invalid params in handler")
+    {
+        router.AddRoute("/test", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params& params) {
+            return rest::Response{.status_code = rest::Response::Status::Ok, .body = std::pmr::string{std::to_string(params.Get<size_t>("count", 1))}, .content_type = rest::ContentType::TextPlain};
+        });
+
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .content_type = rest::ContentType::TextPlain}).body == "1");
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test?count=5", .content_type = rest::ContentType::TextPlain}).body == "5");
+
+        const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test?count=five", .content_type = rest::ContentType::TextPlain});
+        REQUIRE(res.status_code == rest::Response::Status::BadRequest);
+        REQUIRE(res.body == "Invalid value of parameter 'count'");
+    }
+    SUBCASE("too many query params")
+    {
+        router.AddRoute("/test", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) { return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::TextPlain}; });
+
+        std::string path = "/test?";
+        for (size_t i = 0; i <= rest::Params::capacity; ++i)
+            path += "key" + std::to_string(i) + "=value&";
+        path.pop_back();
+        REQUIRE(router.Route(rest::Request{.method = rest::Request::Method::Get, .path = path, .content_type = rest::ContentType::TextPlain}).status_code == rest::Response::Status::BadRequest);
+    }
     SUBCASE("check serialize/deserialize")
     {
         const auto data = SerializableData{.data = 30, .texts = {"hello", "world"}};
@@ -110,38 +281,74 @@ TEST_CASE("Router provide correct routing")
         CHECK(str == R"({"data":30,"texts":["hello","world"]})");
         CHECK(rest::DeSerialize<SerializableData>(str, rest::ContentType::ApplicationJson) == data);
     }
+    SUBCASE("binary content types")
+    {
+        const auto data = SerializableData{.data = 30, .texts = {"hello", "world"}};
+        for (const auto content_type : {rest::ContentType::ApplicationMsgpack, rest::ContentType::ApplicationCbor})
+            CHECK(rest::DeSerialize<SerializableData>(rest::Serialize(data, content_type), content_type) == data);
+
+        router.AddRoute("/test", rest::Request::Method::Post, [](const SerializableData& request, const rest::Router::Params&) { return request; });
+
+        const auto body = rest::Serialize(data, rest::ContentType::ApplicationMsgpack);
+        const auto res  = router.Route(rest::Request{.method = rest::Request::Method::Post, .path = "/test", .body = body, .content_type = rest::ContentType::ApplicationMsgpack, .accept_content_type = rest::ContentType::ApplicationCbor});
+        CHECK(res.status_code == rest::Response::Status::Ok);
+        CHECK(res.content_type == rest::ContentType::ApplicationCbor);
+        CHECK(rest::DeSerialize<SerializableData>(res.body, rest::ContentType::ApplicationCbor) == data);
+    }
+    SUBCASE("responses are allocated from the arena of the request")
+    {
+        router.AddRoute("/test", rest::Request::Method::Post, [](const SerializableData& request, const rest::Router::Params&) { return request; });
+        router.AddRoute("/async", rest::Request::Method::Get, [](const rest::None&, const rest::Router::Params&) -> boost::asio::awaitable<SerializableData> { co_return SerializableData{.data = 1}; });
+
+        std::pmr::monotonic_buffer_resource arena{};
+        const auto                          request = [&arena](std::string_view path, std::string_view body = {}) {
+            return rest::Request{.method = rest::Request::Method::Post, .path = path, .body = body, .content_type = rest::ContentType::ApplicationJson, .arena = &arena};
+        };
+
+        const auto serialized = router.Route(request("/test", R"({"data": 30, "texts" : ["a long enough text to leave the small string buffer"]})"));
+        CHECK(serialized.status_code == rest::Response::Status::Ok);
+        CHECK(serialized.body.get_allocator().resource() == &arena);
+
+        const auto not_found = router.Route(request("/missing"));
+        CHECK(not_found.status_code == rest::Response::Status::NotFound);
+        CHECK(not_found.body.get_allocator().resource() == &arena);
+
+        // Synchronous handler is invoked in place, asynchronous one is left to be awaited
+        CHECK(std::holds_alternative<rest::Response>(router.Dispatch(request("/test", R"({"data": 30, "texts" : []})"))));
+        CHECK(std::holds_alternative<boost::asio::awaitable<rest::Response>>(router.Dispatch(rest::Request{.method = rest::Request::Method::Get, .path = "/async", .content_type = rest::ContentType::ApplicationJson})));
+    }
     SUBCASE("route with custom serializing")
     {
-        auto test = [&] {
+        auto test = [&](auto route) {
             SUBCASE("valid request")
             {
-                const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 30, "texts" : ["hello", "world"]})", .content_type = rest::ContentType::ApplicationJson});
+                const auto res = route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 30, "texts" : ["hello", "world"]})", .content_type = rest::ContentType::ApplicationJson});
                 CHECK(res.status_code == rest::Response::Status::Ok);
                 CHECK(res.content_type == rest::ContentType::ApplicationJson);
                 CHECK(res.body == R"({"data":30,"texts":["hello","world"]})");
             }
             SUBCASE("invalid input json")
             {
-                const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 20, )", .content_type = rest::ContentType::ApplicationJson});
+                const auto res = route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 20, )", .content_type = rest::ContentType::ApplicationJson});
                 CHECK(res.status_code == rest::Response::Status::BadRequest);
                 CHECK(res.body == "Could not parse document");
             }
             SUBCASE("not all required fields")
             {
-                const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"texts" : ["hello", "world"]})", .content_type = rest::ContentType::ApplicationJson});
+                const auto res = route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"texts" : ["hello", "world"]})", .content_type = rest::ContentType::ApplicationJson});
                 CHECK(res.status_code == rest::Response::Status::BadRequest);
                 CHECK(res.body == "Field named 'data' not found.");
             }
             SUBCASE("Unsupported content-type request")
             {
-                const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 30, "texts" : ["hello", "world"]})", .content_type = rest::ContentType::TextPlain});
+                const auto res = route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 30, "texts" : ["hello", "world"]})", .content_type = rest::ContentType::TextPlain});
                 CHECK(res.status_code == rest::Response::Status::BadRequest);
                 CHECK(res.content_type == rest::ContentType::TextPlain);
                 CHECK(res.body == "Unsupported request content type");
             }
             SUBCASE("Unsupported accept-content-type request")
             {
-                const auto res = router.Route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 30, "texts" : ["hello", "world"]})", .content_type = rest::ContentType::ApplicationJson, .accept_content_type = rest::ContentType::TextPlain});
+                const auto res = route(rest::Request{.method = rest::Request::Method::Get, .path = "/test", .body = R"({"data": 30, "texts" : ["hello", "world"]})", .content_type = rest::ContentType::ApplicationJson, .accept_content_type = rest::ContentType::TextPlain});
                 CHECK(res.status_code == rest::Response::Status::BadRequest);
                 CHECK(res.content_type == rest::ContentType::TextPlain);
                 CHECK(res.body == "Unsupported accept content type");
@@ -156,7 +363,7 @@ TEST_CASE("Router provide correct routing")
                 CHECK(request.texts[1] == "world");
                 return rest::Router::SerializableResponse<SerializableData>{.status_code = rest::Response::Status::Ok, .body = SerializableData{.data = 30, .texts = {"hello", "world"}}};
             });
-            test();
+            test([&](const rest::Request& req) { return router.Route(req); });
         }
         SUBCASE("lean serialization")
         {
@@ -167,7 +374,25 @@ TEST_CASE("Router provide correct routing")
                 CHECK(request.texts[1] == "world");
                 return SerializableData{.data = 30, .texts = {"hello", "world"}};
             });
-            test();
+            test([&](const rest::Request& req) { return router.Route(req); });
+        }
+        SUBCASE("explicit asynchronous serialization")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [](const SerializableData& request, const rest::Router::Params&) -> boost::asio::awaitable<rest::Router::SerializableResponse<SerializableData>> {
+                CHECK(request.data == 30);
+                CHECK(request.texts.size() == 2);
+                co_return rest::Router::SerializableResponse<SerializableData>{.status_code = rest::Response::Status::Ok, .body = SerializableData{.data = 30, .texts = {"hello", "world"}}};
+            });
+            test([&](const rest::Request& req) { return RouteAsync(router, req); });
+        }
+        SUBCASE("lean asynchronous serialization")
+        {
+            router.AddRoute("/test", rest::Request::Method::Get, [](const SerializableData& request, const rest::Router::Params&) -> boost::asio::awaitable<SerializableData> {
+                CHECK(request.data == 30);
+                CHECK(request.texts.size() == 2);
+                co_return SerializableData{.data = 30, .texts = {"hello", "world"}};
+            });
+            test([&](const rest::Request& req) { return RouteAsync(router, req); });
         }
     }
 }
@@ -0,0 +1,115 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <boost/beast.hpp>
+#include <libraries/rest/server/rest_server.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+namespace
+{
+    // Allocation-counting hook: every heap allocation is counted unless the current thread opted out (e.g. client side of the test)
+    std::atomic_size_t allocations{};
+    thread_local bool  count_allocations = true;
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if (count_allocations)
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+TEST_CASE("Server handles keep-alive requests within the session arena")
+{
+    // Longer than the small string buffer, so it would take an allocation out of the arena
+    const std::string response_body = "response body which doesn't fit into the small string buffer";
+
+    std::atomic_bool arena_passed{true};
+    auto             router = rest::Router{};
+    router.AddRoute("/test", rest::Request::Method::Post, [&](const rest::Request& req, const rest::Router::Params& params) {
+        if (req.arena == std::pmr::get_default_resource() || params.Get<size_t>("count") != 1)
+            arena_passed = false;
+        return rest::Response{.status_code = rest::Response::Status::Ok, .body = std::pmr::string{response_body, req.arena}, .content_type = rest::ContentType::TextPlain};
+    });
+
+    const auto config     = rest::ServerConfig{.port = 8085};
+    auto       stop_token = rest::StartServer(std::move(router), config);
+
+    count_allocations = false;
+    net::io_context   ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint{net::ip::make_address(config.address), config.port});
+
+    http::request<http::string_body> req{http::verb::post, "/test?count=1", 11};
+    req.set(http::field::content_type, "application/json");
+    req.set(http::field::accept, "text/plain");
+    req.set(http::field::user_agent, "rest_server_allocations_ut");
+    req.body() = R"({"name":"task name","description":"task description"})";
+    req.keep_alive(true);
+    req.prepare_payload();
+
+    beast::flat_buffer buffer;
+    const auto         send = [&] {
+        http::response<http::string_body> res;
+        http::write(stream, req);
+        http::read(stream, buffer, res);
+        REQUIRE(res.result() == http::status::ok);
+        REQUIRE(res.body() == response_body);
+    };
+
+    // Session arena and asio's per-thread caches of coroutine frames and operations are warmed up first
+    for (size_t i = 0; i < 10; ++i)
+        send();
+
+    constexpr size_t requests = 1000;
+    const auto       before   = allocations.load();
+    for (size_t i = 0; i < requests; ++i)
+        send();
+    const auto per_request = static_cast<double>(allocations.load() - before) / requests;
+
+    // Parser, request, routing, response and its body live in the arena and synchronous handler costs no coroutine frame,
+    // what is left are socket read and write operations missing asio's per-thread cache, which is shared with the stream's timer
+    MESSAGE("allocations per request: " << per_request);
+    CHECK(per_request <= 2);
+    CHECK(arena_passed);
+
+    stop_token.Stop();
+}
@@ -0,0 +1,109 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+#include <nanobench.h>
+
+#include <boost/beast.hpp>
+#include <libraries/rest/server/rest_server.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+namespace
+{
+    constexpr size_t server_threads      = 4;
+    constexpr size_t clients             = 32;
+    constexpr size_t requests_per_client = 200;
+
+    /**
+     * @brief Runs `clients` keep-alive connections sending requests back to back and collects latency of every request
+     */
+    void RunClients(const rest::ServerConfig& config, std::vector<std::chrono::nanoseconds>& latencies, std::mutex& mutex)
+    {
+        std::vector<std::thread> threads{};
+        for (size_t client = 0; client < clients; ++client)
+        {
+            threads.emplace_back([&] {
+                net::io_context   ioc;
+                beast::tcp_stream stream(ioc);
+                stream.connect(tcp::endpoint{net::ip::make_address(config.address), config.port});
+
+                http::request<http::string_body> req{http::verb::get, "/ping", 11};
+                req.set(http::field::content_type, "text/plain");
+                req.set(http::field::accept, "text/plain");
+                req.keep_alive(true);
+
+                beast::flat_buffer                    buffer;
+                std::vector<std::chrono::nanoseconds> local{};
+                local.reserve(requests_per_client);
+                for (size_t i = 0; i < requests_per_client; ++i)
+                {
+                    const auto                        start = std::chrono::steady_clock::now();
+                    http::response<http::string_body> res;
+                    http::write(stream, req);
+                    http::read(stream, buffer, res);
+                    local.push_back(std::chrono::steady_clock::now() - start);
+                }
+
+                std::lock_guard lock{mutex};
+                latencies.insert(latencies.end(), local.begin(), local.end());
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void BenchMode(ankerl::nanobench::Bench& bench, const std::string& name, rest::ServerConfig config)
+    {
+        rest::Router router{};
+        router.AddRoute("/ping", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) {
+            return rest::Response{.status_code = rest::Response::Status::Ok, .body = "pong", .content_type = rest::ContentType::TextPlain};
+        });
+        auto stop_token = rest::StartServer(std::move(router), config);
+
+        std::mutex                            mutex{};
+        std::vector<std::chrono::nanoseconds> latencies{};
+        bench.batch(clients * requests_per_client).run(name, [&] { RunClients(config, latencies, mutex); });
+
+        stop_token.Stop();
+
+        std::ranges::sort(latencies);
+        const auto percentile = [&](double p) { return std::chrono::duration<double, std::micro>(latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))]).count(); };
+        std::cout << name << ": p50 " << percentile(0.5) << "us, p99 " << percentile(0.99) << "us, p99.9 " << percentile(0.999) << "us\n";
+    }
+} // namespace
+
+TEST_CASE("Server throughput and latency by threading mode")
+{
+    ankerl::nanobench::Bench bench{};
+    bench.title("Server, " + std::to_string(server_threads) + " threads, " + std::to_string(clients) + " keep-alive clients").unit("request").epochs(5).epochIterations(1).relative(true);
+
+    BenchMode(bench, "shared context", rest::ServerConfig{.port = 8090, .threads = server_threads});
+    BenchMode(bench, "context per thread", rest::ServerConfig{.port = 8091, .threads = server_threads, .mode = rest::ServerConfig::Mode::ContextPerThread});
+    BenchMode(bench, "context per thread, pinned", rest::ServerConfig{.port = 8092, .threads = server_threads, .mode = rest::ServerConfig::Mode::ContextPerThread, .pin_threads = true});
+}
@@ -19,12 +19,25 @@
 
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/co_spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/http.hpp>
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <list>
+#include <memory_resource>
+#include <string>
 #include <thread>
+#include <variant>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace beast = boost::beast;
 namespace http  = beast::http;
@@ -35,6 +48,15 @@ namespace rest
 {
     namespace
     {
+        // Headers and body of a small request and headers of its response fit into the initial buffer of the session arena, so they don't touch the heap at all
+        constexpr size_t session_arena_size = 4 * 1024;
+
+        using ArenaAllocator = std::pmr::polymorphic_allocator<char>;
+        using ArenaFields    = http::basic_fields<ArenaAllocator>;
+        using ArenaBody      = http::basic_string_body<char, std::char_traits<char>, ArenaAllocator>;
+        using RequestParser  = http::request_parser<ArenaBody, ArenaAllocator>;
+        using HttpRequest    = http::request<ArenaBody, ArenaFields>;
+
         void LogError(std::exception_ptr e)
         {
             if (e)
@@ -63,8 +85,8 @@ namespace rest
             {
             }
 
-            Router           router;
-            std::atomic_bool started{};
+            Router             router;
+            std::atomic_size_t listening{};
         };
 
         std::optional<rest::Request::Method> ParseMethod(http::verb method)
@@ -82,50 +104,116 @@ namespace rest
             }
         }
 
-        boost::beast::http::response<boost::beast::http::string_body> CreateResponse(const rest::Response& response)
+        template<typename Body, typename... BodyArgs>
+        http::response<Body, ArenaFields> CreateHeader(const rest::Response& response, bool keep_alive, std::pmr::memory_resource& arena, BodyArgs&&... body_args)
         {
-            boost::beast::http::response<boost::beast::http::string_body> res;
+            http::response<Body, ArenaFields> res{std::piecewise_construct, std::forward_as_tuple(std::forward<BodyArgs>(body_args)...), std::make_tuple(ArenaAllocator{&arena})};
             res.result(static_cast<uint16_t>(response.status_code.get()));
             res.set(http::field::server, "JustQueueIt");
             res.set(http::field::content_type, ParseContentType(response.content_type));
-            res.body() = response.body;
+            res.keep_alive(keep_alive);
+            return res;
+        }
+
+        http::response<ArenaBody, ArenaFields> CreateResponse(rest::Response&& response, bool keep_alive, std::pmr::memory_resource& arena)
+        {
+            // Body is forbidden for informational, "No Content" and "Not Modified" responses.
+            // It is moved rather than assigned, so body serialized by the router into the arena is not copied
+            const auto status   = response.status_code.get();
+            const auto has_body = static_cast<uint16_t>(status) >= 200 && status != Response::Status::NoContent && status != Response::Status::NotModified;
+            auto       res      = CreateHeader<ArenaBody>(response, keep_alive, arena, has_body ? std::move(response.body) : std::pmr::string{&arena});
             res.prepare_payload();
             return res;
         }
 
-        Response PrepareResponse(const http::request<http::string_body>& req, const Router& router)
+        /**
+         * @brief Writes header first and then every part of the streamed body as a separate chunk, so only one chunk is kept in memory at a time
+         */
+        net::awaitable<void> WriteChunked(beast::tcp_stream& stream, rest::Response&& response, bool keep_alive, std::pmr::memory_resource& arena)
+        {
+            auto header = CreateHeader<http::empty_body>(response, keep_alive, arena);
+            header.chunked(true);
+
+            http::response_serializer<http::empty_body, ArenaFields> serializer{header};
+            co_await http::async_write_header(stream, serializer, net::use_awaitable);
+
+            std::string chunk{};
+            for (bool more = true; more;)
+            {
+                chunk.clear();
+                more = response.stream(chunk);
+                if (chunk.empty())
+                    continue;
+
+                stream.expires_after(std::chrono::seconds(30));
+                co_await net::async_write(stream, http::make_chunk(net::buffer(chunk)), net::use_awaitable);
+            }
+            co_await net::async_write(stream, http::make_chunk_last(), net::use_awaitable);
+        }
+
+        /**
+         * @return request for the router, otherwise response with error
+         */
+        std::variant<Request, Response> PrepareRequest(const HttpRequest& req, std::pmr::memory_resource& arena)
         {
             const auto method = ParseMethod(req.method());
             if (!method)
-                return Response{.status_code = Response::Status::MethodNotAllowed, .body = "Unsupported or unknown method", .content_type = rest::ContentType::TextPlain};
+                return Response{.status_code = Response::Status::MethodNotAllowed, .body = std::pmr::string{"Unsupported or unknown method", &arena}, .content_type = rest::ContentType::TextPlain};
 
             const auto content_type = ParseContentType(req[http::field::content_type]);
             if (!content_type)
-                return Response{.status_code = Response::Status::BadRequest, .body = "Unsupported or unknown content type", .content_type = rest::ContentType::TextPlain};
+                return Response{.status_code = Response::Status::BadRequest, .body = std::pmr::string{"Unsupported or unknown content type", &arena}, .content_type = rest::ContentType::TextPlain};
 
             const auto accept_content_type = ParseContentType(req[http::field::accept]);
             if (!accept_content_type)
-                return Response{.status_code = Response::Status::BadRequest, .body = "Unsupported or unknown accept content type", .content_type = rest::ContentType::TextPlain};
+                return Response{.status_code = Response::Status::BadRequest, .body = std::pmr::string{"Unsupported or unknown accept content type", &arena}, .content_type = rest::ContentType::TextPlain};
 
-            return router.Route({.method = method.value(), .path = req.target(), .body = req.body(), .content_type = content_type.value(), .accept_content_type = accept_content_type.value()});
+            return Request{.method = method.value(), .path = req.target(), .body = req.body(), .content_type = content_type.value(), .accept_content_type = accept_content_type.value(), .arena = &arena};
         }
 
         net::awaitable<void> DoSession(beast::tcp_stream stream, std::shared_ptr<ServerContext> ctx)
         {
             // This buffer is required to persist across reads
             beast::flat_buffer buffer;
+
+            // Parser, request, response and body serialized by the router are allocated from the arena and released at once after the response is sent,
+            // so they don't allocate in steady state of keep-alive session
+            std::array<std::byte, session_arena_size> arena_buffer;
+            std::pmr::monotonic_buffer_resource       arena{arena_buffer.data(), arena_buffer.size()};
             while (true)
             {
+                arena.release();
                 stream.expires_after(std::chrono::seconds(30));
 
-                http::request<http::string_body> req;
-                co_await http::async_read(stream, buffer, req);
+                // Parser is owned here rather than by async_read, so reading doesn't allocate it on every request
+                RequestParser parser{std::piecewise_construct, std::make_tuple(ArenaAllocator{&arena}), std::make_tuple(ArenaAllocator{&arena})};
+                co_await http::async_read(stream, buffer, parser, net::use_awaitable);
+
+                const auto& req        = parser.get();
+                bool        keep_alive = req.keep_alive();
 
-                bool keep_alive = req.keep_alive();
+                auto prepared = PrepareRequest(req, arena);
+                if (const auto* request = std::get_if<Request>(&prepared))
+                {
+                    // Synchronous handler is invoked in place, so only asynchronous one costs a coroutine frame
+                    auto dispatched = ctx->router.Dispatch(*request);
+                    if (auto* awaitable = std::get_if<net::awaitable<Response>>(&dispatched))
+                        prepared = co_await std::move(*awaitable);
+                    else
+                        prepared = std::get<Response>(std::move(dispatched));
+                }
+                auto& response = std::get<Response>(prepared);
 
-                auto response = CreateResponse(PrepareResponse(req, ctx->router));
-                response.keep_alive(keep_alive);
-                co_await beast::async_write(stream, boost::beast::http::message_generator{std::move(response)});
+                // Handler could be suspended for a long time (e.g. long polling), so write gets its own timeout
+                stream.expires_after(std::chrono::seconds(30));
+                if (response.stream)
+                    co_await WriteChunked(stream, std::move(response), keep_alive, arena);
+                else
+                {
+                    auto                                               res = CreateResponse(std::move(response), keep_alive, arena);
+                    http::response_serializer<ArenaBody, ArenaFields> serializer{res};
+                    co_await http::async_write(stream, serializer, net::use_awaitable);
+                }
 
                 // Send a TCP shutdown
                 if (keep_alive)
@@ -136,7 +224,7 @@ namespace rest
             }
         }
 
-        net::awaitable<void> DoListen(net::ip::tcp::endpoint endpoint, std::shared_ptr<ServerContext> ctx)
+        net::awaitable<void> DoListen(net::ip::tcp::endpoint endpoint, bool reuse_port, std::shared_ptr<ServerContext> ctx)
         {
             auto acceptor = net::use_awaitable.as_default_on(tcp::acceptor(co_await net::this_coro::executor));
             acceptor.open(endpoint.protocol());
@@ -144,14 +232,24 @@ namespace rest
             // Allow address reuse
             acceptor.set_option(net::socket_base::reuse_address(true));
 
+            // Allow several acceptors on the same port, kernel balances incoming connections between them
+            if (reuse_port)
+            {
+#ifdef SO_REUSEPORT
+                acceptor.set_option(net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#else
+                throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+#endif
+            }
+
             // Bind to the server address
             acceptor.bind(endpoint);
 
             // Start listening for connections
             acceptor.listen(net::socket_base::max_listen_connections);
 
-            ctx->started.store(true);
-            ctx->started.notify_all();
+            ctx->listening.fetch_add(1);
+            ctx->listening.notify_all();
 
             for (;;)
             {
@@ -161,18 +259,49 @@ namespace rest
                     &LogError);
             }
         }
+
+        net::awaitable<void> DoPeriodic(PeriodicTask task)
+        {
+            net::steady_timer timer{co_await net::this_coro::executor};
+            for (;;)
+            {
+                timer.expires_after(task.interval);
+                co_await timer.async_wait(net::use_awaitable);
+
+                try
+                {
+                    task.callback();
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "Error in periodic task: " << e.what() << "\n";
+                }
+            }
+        }
     } // namespace
 
     struct ServerLifetime
     {
-        explicit ServerLifetime(int threads)
-            : ioc{threads}
+        // io_context is not movable, so list keeps them stable
+        std::list<boost::asio::io_context> contexts{};
+        std::vector<std::thread>           threads{};
+    };
+
+    namespace
+    {
+        void PinToCpu([[maybe_unused]] std::thread& thread, [[maybe_unused]] size_t index)
         {
+#ifdef __linux__
+            const auto cpus = std::max(1u, std::thread::hardware_concurrency());
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(index % cpus, &set);
+            if (const auto err = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set); err != 0)
+                std::cerr << "Failed to pin server thread to cpu " << index % cpus << ": " << err << "\n";
+#endif
         }
-
-        boost::asio::io_context  ioc;
-        std::vector<std::thread> threads{};
-    };
+    } // namespace
 
     StopHandler::StopHandler(std::shared_ptr<ServerLifetime> ctx)
         : m_ctx{std::move(ctx)}
@@ -186,9 +315,10 @@ namespace rest
 
     void StopHandler::Stop() const
     {
-        if (!m_ctx->ioc.stopped())
+        if (std::ranges::any_of(m_ctx->contexts, [](const auto& ioc) { return !ioc.stopped(); }))
         {
-            m_ctx->ioc.stop();
+            for (auto& ioc : m_ctx->contexts)
+                ioc.stop();
             Wait();
         }
     }
@@ -200,23 +330,40 @@ namespace rest
                 t.join();
     }
 
-    StopHandler StartServer(Router&& router, const ServerConfig& config)
+    StopHandler StartServer(Router&& router, const ServerConfig& config, std::vector<PeriodicTask> periodic_tasks)
     {
         auto server_ctx = std::make_shared<ServerContext>(std::move(router));
 
-        const auto max_threads     = std::max(size_t{1}, config.threads);
-        auto       server_lifetime = std::make_shared<ServerLifetime>(max_threads);
+        const auto max_threads        = std::max(size_t{1}, config.threads);
+        const auto context_per_thread = config.mode == ServerConfig::Mode::ContextPerThread;
+        const auto contexts_count     = context_per_thread ? max_threads : 1;
+        auto       server_lifetime    = std::make_shared<ServerLifetime>();
+
+        const auto endpoint = net::ip::tcp::endpoint{net::ip::make_address(config.address), config.port};
+        for (size_t i = 0; i < contexts_count; ++i)
+        {
+            auto& ioc = server_lifetime->contexts.emplace_back(static_cast<int>(context_per_thread ? 1 : max_threads));
+            net::co_spawn(ioc, DoListen(endpoint, context_per_thread, server_ctx), &LogError);
+        }
 
-        net::co_spawn(server_lifetime->ioc, DoListen(net::ip::tcp::endpoint{net::ip::make_address(config.address), config.port}, server_ctx), &LogError);
+        // Periodic tasks are not expected to be thread-safe, so all of them share the first context
+        for (auto& task : periodic_tasks)
+            net::co_spawn(server_lifetime->contexts.front(), DoPeriodic(std::move(task)), &LogError);
 
-        for (size_t threads = 0; threads < max_threads; ++threads)
+        auto context = server_lifetime->contexts.begin();
+        for (size_t index = 0; index < max_threads; ++index)
         {
-            server_lifetime->threads.emplace_back([server_lifetime] {
-                server_lifetime->ioc.run();
+            auto& thread = server_lifetime->threads.emplace_back([server_lifetime, &ioc = *context] {
+                ioc.run();
             });
+            if (config.pin_threads)
+                PinToCpu(thread, index);
+            if (context_per_thread)
+                ++context;
         }
 
-        server_ctx->started.wait(false);
+        for (auto listening = server_ctx->listening.load(); listening < contexts_count; listening = server_ctx->listening.load())
+            server_ctx->listening.wait(listening);
 
         return StopHandler{std::move(server_lifetime)};
     }
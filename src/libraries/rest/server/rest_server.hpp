@@ -19,7 +19,10 @@
 
 #include <libraries/rest/router/rest_router.hpp>
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace rest
 {
@@ -40,10 +43,29 @@ namespace rest
 
     struct ServerConfig
     {
-        std::string address = "127.0.0.1";
-        uint16_t    port    = 8080;
-        size_t      threads = 1;
+        enum class Mode
+        {
+            /// All threads run single io_context with single acceptor, sessions are executed by any of threads
+            SharedContext,
+            /// Each thread runs own io_context with own `SO_REUSEPORT` acceptor, so session stays on the thread which accepted it
+            ContextPerThread,
+        };
+
+        std::string address     = "127.0.0.1";
+        uint16_t    port        = 8080;
+        size_t      threads     = 1;
+        Mode        mode        = Mode::SharedContext;
+        bool        pin_threads = false; // Pin every thread to its own CPU, Linux only
+    };
+
+    /**
+     * @brief Callback invoked by the server's io_context every `interval` while server is running
+     */
+    struct PeriodicTask
+    {
+        std::chrono::steady_clock::duration interval;
+        std::function<void()>               callback;
     };
 
-    StopHandler StartServer(rest::Router&& router, const ServerConfig& config);
+    StopHandler StartServer(rest::Router&& router, const ServerConfig& config, std::vector<PeriodicTask> periodic_tasks = {});
 } // namespace rest
@@ -21,6 +21,11 @@
 #include <boost/beast.hpp>
 #include <libraries/rest/server/rest_server.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
 namespace beast = boost::beast;
 namespace http  = beast::http;
 namespace net   = boost::asio;
@@ -110,3 +115,77 @@ TEST_CASE("BackendServer provides correct api")
 
     stop_token.Stop();
 }
+
+TEST_CASE("Server runs periodic tasks")
+{
+    std::atomic_size_t calls{};
+    std::atomic_size_t failures{};
+
+    const auto config     = rest::ServerConfig{.port = 8081};
+    auto       stop_token = rest::StartServer(rest::Router{},
+                                        config,
+                                        {rest::PeriodicTask{.interval = std::chrono::milliseconds{1}, .callback = [&calls] { ++calls; }},
+                                         rest::PeriodicTask{.interval = std::chrono::milliseconds{1}, .callback = [&failures] {
+                                                                ++failures;
+                                                                throw std::runtime_error("failure");
+                                                            }}});
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while ((calls < 3 || failures < 3) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+    stop_token.Stop();
+    CHECK(calls >= 3);
+    CHECK(failures >= 3);
+}
+
+TEST_CASE("Server with context per thread serves requests on every thread")
+{
+    constexpr size_t threads = 4;
+
+    std::mutex                mutex{};
+    std::set<std::thread::id> handled_by{};
+    auto                      router = rest::Router{};
+    router.AddRoute("/test", rest::Request::Method::Get, [&](const rest::Request&, const rest::Router::Params&) {
+        std::lock_guard lock{mutex};
+        handled_by.insert(std::this_thread::get_id());
+        return rest::Response{.status_code = rest::Response::Status::Ok, .body = "test", .content_type = rest::ContentType::TextPlain};
+    });
+
+    const auto config     = rest::ServerConfig{.port = 8082, .threads = threads, .mode = rest::ServerConfig::Mode::ContextPerThread, .pin_threads = true};
+    auto       stop_token = rest::StartServer(std::move(router), config);
+
+    // Kernel balances connections between acceptors by hash of the client's address and port, so enough connections reach every one of them
+    for (size_t i = 0; i < 200; ++i)
+    {
+        const auto resp = MakeRequest("/test", config);
+        REQUIRE(resp.result() == http::status::ok);
+        REQUIRE(resp.body() == "test");
+    }
+
+    stop_token.Stop();
+    CHECK(handled_by.size() > 1);
+    CHECK(handled_by.size() <= threads);
+}
+
+TEST_CASE("Server sends streamed body with chunked transfer encoding")
+{
+    auto router = rest::Router{};
+    router.AddRoute("/stream", rest::Request::Method::Get, [](const rest::Request&, const rest::Router::Params&) {
+        return rest::Response{.status_code = rest::Response::Status::Ok, .content_type = rest::ContentType::ApplicationJson, .stream = [part = 0](std::string& chunk) mutable {
+                                  chunk += "part" + std::to_string(part);
+                                  return ++part < 3;
+                              }};
+    });
+
+    const auto config     = rest::ServerConfig{.port = 8083};
+    auto       stop_token = rest::StartServer(std::move(router), config);
+
+    const auto resp = MakeRequest("/stream", config);
+    CHECK(resp.result() == http::status::ok);
+    CHECK(resp.chunked());
+    CHECK(resp.body() == "part0part1part2");
+    CHECK(resp[http::field::content_type] == rest::ParseContentType(rest::ContentType::ApplicationJson));
+
+    stop_token.Stop();
+}
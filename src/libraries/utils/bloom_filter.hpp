@@ -0,0 +1,101 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Blocked Bloom filter of 64-bit hashes: every bit of a hash falls into one cache line, so a check costs a single cache miss.
+     * @details Sized for `capacity` hashes below 1% of false positives, memory is allocated on the first insertion.
+     * Hashes are remixed, so weak ones (e.g. identity hash of integers) are fine too.
+     */
+    class BloomFilter
+    {
+    public:
+        explicit BloomFilter(size_t capacity)
+            : m_blocks_count{std::max<size_t>(1, (capacity * bits_per_hash + block_bits - 1) / block_bits)}
+        {
+        }
+
+        void Insert(uint64_t hash)
+        {
+            if (m_blocks.empty())
+                m_blocks.resize(m_blocks_count);
+
+            hash        = Mix(hash);
+            auto& block = m_blocks[BlockIndex(hash)];
+            for (size_t i = 0; i < words_count; ++i)
+                block.words[i] |= Bit(hash, i);
+        }
+
+        bool MayContain(uint64_t hash) const
+        {
+            if (m_blocks.empty())
+                return false;
+
+            hash              = Mix(hash);
+            const auto& block = m_blocks[BlockIndex(hash)];
+
+            // No early exit: misses are the common case and a branch per word mispredicts on them, while checking the whole cache line vectorizes
+            uint64_t missing = 0;
+            for (size_t i = 0; i < words_count; ++i)
+                missing |= Bit(hash, i) & ~block.words[i];
+            return missing == 0;
+        }
+
+        /**
+         * @brief Forgets every hash, keeping the memory
+         */
+        void Clear() { std::ranges::fill(m_blocks, Block{}); }
+
+    private:
+        static constexpr size_t words_count   = 8;
+        static constexpr size_t block_bits    = words_count * 64;
+        static constexpr size_t bits_per_hash = 12;
+
+        // One bit per word of the block, picked by its own odd multiplier of the low half of the hash
+        static constexpr std::array<uint32_t, words_count> salts{0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+        struct alignas(64) Block
+        {
+            std::array<uint64_t, words_count> words{};
+        };
+
+        static uint64_t Mix(uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        size_t BlockIndex(uint64_t hash) const { return static_cast<size_t>(((hash >> 32) * m_blocks_count) >> 32); }
+
+        static uint64_t Bit(uint64_t hash, size_t word) { return uint64_t{1} << ((static_cast<uint32_t>(hash) * salts[word]) >> 26); }
+
+    private:
+        size_t             m_blocks_count;
+        std::vector<Block> m_blocks{};
+    };
+} // namespace utils
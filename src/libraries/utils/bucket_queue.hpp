@@ -0,0 +1,139 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace utils
+{
+    /**
+     * @brief Not thread-safe bounded queue ordered by priority first and by insertion within the same priority.
+     * @details Every `uint8_t` priority has its own FIFO bucket and a bitmap of non-empty buckets points to the highest one in a few word scans,
+     * so push and pop are O(1) whatever the count of queued values is.
+     * Values can't be removed from the middle, instead the owner marks them stale: they don't count against the capacity and are
+     * dropped when popped, or erased at once by EraseStale when they outnumber live ones.
+     */
+    template<typename T>
+    class BucketQueue
+    {
+        static constexpr size_t buckets_count = size_t{std::numeric_limits<uint8_t>::max()} + 1;
+        static constexpr size_t word_bits     = std::numeric_limits<uint64_t>::digits;
+
+        // Erasing a handful of stale values isn't worth a pass over all buckets
+        static constexpr size_t min_stale_to_erase = 64;
+
+    public:
+        explicit BucketQueue(size_t capacity)
+            : m_capacity{capacity}
+        {
+        }
+
+        /**
+         * @brief Pushes value behind all values of the same priority
+         * @return false if queue is full
+         */
+        bool TryPush(T value, uint8_t priority)
+        {
+            if (Size() >= m_capacity)
+                return false;
+
+            m_buckets[priority].push_back(std::move(value));
+            m_non_empty[priority / word_bits] |= uint64_t{1} << (priority % word_bits);
+            ++m_size;
+            return true;
+        }
+
+        /**
+         * @brief Pops the oldest value of the highest priority
+         * @return empty optional if queue is empty
+         */
+        std::optional<T> TryPop()
+        {
+            for (size_t word = m_non_empty.size(); word > 0; --word)
+            {
+                const auto bits = m_non_empty[word - 1];
+                if (bits == 0)
+                    continue;
+
+                const auto       priority = (word - 1) * word_bits + (word_bits - 1 - static_cast<size_t>(std::countl_zero(bits)));
+                auto&            bucket   = m_buckets[priority];
+                std::optional<T> result{std::move(bucket.front())};
+                bucket.pop_front();
+                if (bucket.empty())
+                    m_non_empty[word - 1] &= ~(uint64_t{1} << (priority % word_bits));
+
+                --m_size;
+                return result;
+            }
+            return {};
+        }
+
+        /**
+         * @brief Marks one of queued values stale (e.g. id of a deleted task), the owner calls DropStale once it pops that value
+         */
+        void MarkStale() { ++m_stale; }
+
+        /**
+         * @brief Popped value turned out to be a stale one
+         */
+        void DropStale() { --m_stale; }
+
+        /**
+         * @brief Stale values are worth erasing once they outnumber live ones, so erasing costs O(1) per stale value in amortized terms
+         */
+        bool HasManyStale() const { return m_stale > min_stale_to_erase && m_stale * 2 > m_size; }
+
+        /**
+         * @brief Erases queued values for which `is_stale(value)` returns true, each of them must have been marked stale
+         */
+        template<std::predicate<const T&> Predicate>
+        void EraseStale(Predicate&& is_stale)
+        {
+            for (size_t priority = 0; priority < buckets_count; ++priority)
+            {
+                auto&      bucket = m_buckets[priority];
+                const auto erased = static_cast<size_t>(std::erase_if(bucket, is_stale));
+                m_size -= erased;
+                m_stale -= erased;
+                if (bucket.empty())
+                    m_non_empty[priority / word_bits] &= ~(uint64_t{1} << (priority % word_bits));
+            }
+        }
+
+        /**
+         * @brief Count of live values, stale ones are not counted
+         */
+        size_t Size() const { return m_size > m_stale ? m_size - m_stale : 0; }
+        size_t Capacity() const { return m_capacity; }
+
+    private:
+        size_t                                          m_capacity;
+        size_t                                          m_size{};
+        size_t                                          m_stale{};
+        std::array<uint64_t, buckets_count / word_bits> m_non_empty{};
+        std::array<std::deque<T>, buckets_count>        m_buckets{};
+    };
+} // namespace utils
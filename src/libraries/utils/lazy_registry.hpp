@@ -0,0 +1,124 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+#pragma once
+
+#include <libraries/utils/rcu.hpp>
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Thread-safe bounded map from string keys to values created on first access and kept till the registry is destroyed.
+     * @details Lookup of an existing key takes no locks: readers search an immutable index published through RCU.
+     * Creation is serialized by a mutex, copies the index (keys are few and created rarely) and publishes the copy, so readers never wait for it.
+     * Values never move, so references to them stay valid for the lifetime of the registry.
+     */
+    template<typename T>
+    class LazyRegistry
+    {
+    public:
+        explicit LazyRegistry(size_t max_size)
+            : m_max_size{max_size}
+            , m_index{new Index{}}
+        {
+        }
+
+        ~LazyRegistry() { delete m_index.load(std::memory_order_relaxed); }
+
+        LazyRegistry(const LazyRegistry&)            = delete;
+        LazyRegistry& operator=(const LazyRegistry&) = delete;
+
+        const T* Find(std::string_view key) const
+        {
+            const auto  guard = m_rcu.Read();
+            const auto* index = m_index.load(std::memory_order_acquire);
+            const auto  itr   = index->find(key);
+            return itr == index->end() ? nullptr : itr->second;
+        }
+
+        /**
+         * @brief Returns value of `key`, creating it by `factory()` if it is missing. Factory is invoked at most once per key.
+         * @throws std::length_error if `key` is missing and registry is full
+         */
+        template<std::invocable Factory>
+        const T& GetOrCreate(std::string_view key, Factory&& factory)
+        {
+            if (const auto* value = Find(key))
+                return *value;
+
+            std::lock_guard _{m_mutex};
+            const auto*     current = m_index.load(std::memory_order_relaxed);
+            if (const auto itr = current->find(key); itr != current->end())
+                return *itr->second;
+
+            if (m_entries.size() >= m_max_size)
+                throw std::length_error("Registry is full");
+
+            std::unique_ptr<Entry> entry{new Entry{.key = std::string{key}, .value = factory()}};
+            auto*                  index = new Index{*current};
+            index->emplace(entry->key, &entry->value);
+            const auto& value = m_entries.emplace_back(std::move(entry))->value;
+
+            m_rcu.Retire(m_index.exchange(index, std::memory_order_acq_rel));
+            return value;
+        }
+
+        /**
+         * @brief Invokes `fn(key, value)` for every value created so far
+         */
+        template<std::invocable<std::string_view, const T&> Fn>
+        void ForEach(Fn&& fn) const
+        {
+            const auto guard = m_rcu.Read();
+            for (const auto& [key, value] : *m_index.load(std::memory_order_acquire))
+                fn(key, *value);
+        }
+
+        size_t Size() const
+        {
+            const auto guard = m_rcu.Read();
+            return m_index.load(std::memory_order_acquire)->size();
+        }
+
+    private:
+        struct Entry
+        {
+            std::string key;
+            T           value;
+        };
+
+        using Index = std::unordered_map<std::string_view, const T*>;
+
+    private:
+        const size_t                        m_max_size;
+        mutable Rcu                         m_rcu{};
+        std::atomic<const Index*>           m_index;
+        std::mutex                          m_mutex{};
+        std::vector<std::unique_ptr<Entry>> m_entries{}; // Guarded by m_mutex
+    };
+} // namespace utils
@@ -0,0 +1,150 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Read-copy-update domain: readers never block or wait, writer unlinks shared objects and retires them to be destroyed once no reader can observe them anymore.
+     * @details Readers register in one of two generations of counters striped over cache lines. Writer advances generation only when all readers of the previous one are gone
+     * and destroys objects retired two generations ago, so writer never waits for readers either. Retire/TryReclaim must be serialized externally (single writer).
+     */
+    class Rcu
+    {
+        static constexpr size_t stripes           = 16;
+        static constexpr size_t reclaim_threshold = 64;
+
+        struct alignas(64) Counter
+        {
+            std::atomic_size_t value{};
+        };
+
+    public:
+        class ReadGuard
+        {
+        public:
+            ReadGuard(const ReadGuard&)            = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+
+            ~ReadGuard() { m_counter.fetch_sub(1, std::memory_order_release); }
+
+        private:
+            friend class Rcu;
+
+            explicit ReadGuard(std::atomic_size_t& counter)
+                : m_counter{counter}
+            {
+            }
+
+        private:
+            std::atomic_size_t& m_counter;
+        };
+
+        Rcu() = default;
+
+        Rcu(const Rcu&)            = delete;
+        Rcu& operator=(const Rcu&) = delete;
+
+        ~Rcu()
+        {
+            for (auto& retired : m_retired)
+                Destroy(retired);
+        }
+
+        /**
+         * @brief Protects every object loaded while guard is alive from destruction
+         */
+        [[nodiscard]] ReadGuard Read() const
+        {
+            const auto stripe = Stripe();
+            while (true)
+            {
+                const auto epoch   = m_epoch.load(std::memory_order_seq_cst);
+                auto&      counter = m_readers[epoch & 1][stripe].value;
+                counter.fetch_add(1, std::memory_order_seq_cst);
+
+                // Generation could be advanced in between, writer could have missed this reader then
+                if (m_epoch.load(std::memory_order_seq_cst) == epoch)
+                    return ReadGuard{counter};
+                counter.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        /**
+         * @brief Destroys already unlinked object once no reader can observe it
+         */
+        template<typename T>
+        void Retire(T* object)
+        {
+            auto& retired = m_retired[m_epoch.load(std::memory_order_relaxed) & 1];
+            retired.push_back(Retired{.object = object, .destroy = [](const void* ptr) { delete static_cast<const T*>(ptr); }});
+            if (retired.size() >= reclaim_threshold)
+                TryReclaim();
+        }
+
+        /**
+         * @brief Advances generation and destroys objects retired during the previous one if all of its readers are gone
+         * @return false if readers of the previous generation are still active
+         */
+        bool TryReclaim()
+        {
+            const auto epoch    = m_epoch.load(std::memory_order_relaxed);
+            const auto previous = (epoch + 1) & 1;
+            if (std::ranges::any_of(m_readers[previous], [](const Counter& counter) { return counter.value.load(std::memory_order_seq_cst) != 0; }))
+                return false;
+
+            // Readers of the current generation entered after these objects were unlinked
+            Destroy(m_retired[previous]);
+            m_epoch.store(epoch + 1, std::memory_order_seq_cst);
+            return true;
+        }
+
+    private:
+        struct Retired
+        {
+            const void* object;
+            void (*destroy)(const void*);
+        };
+
+        static size_t Stripe()
+        {
+            thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % stripes;
+            return stripe;
+        }
+
+        static void Destroy(std::vector<Retired>& retired)
+        {
+            for (const auto& item : retired)
+                item.destroy(item.object);
+            retired.clear();
+        }
+
+    private:
+        std::atomic_size_t                                  m_epoch{};
+        mutable std::array<std::array<Counter, stripes>, 2> m_readers{};
+        std::array<std::vector<Retired>, 2>                 m_retired{};
+    };
+} // namespace utils
@@ -0,0 +1,147 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Not thread-safe hierarchical timing wheel measured in abstract ticks.
+     * @details Scheduling is O(1), advancing skips ranges of ticks without entries and costs O(1) amortized per entry (every entry is cascaded at most `levels` times).
+     * Entries can't be cancelled: owner is expected to validate expired values lazily.
+     */
+    template<typename T>
+    class TimingWheel
+    {
+        static constexpr size_t   bits   = 8;
+        static constexpr size_t   levels = 4;
+        static constexpr uint64_t slots  = uint64_t{1} << bits;
+        static constexpr uint64_t mask   = slots - 1;
+
+    public:
+        explicit TimingWheel(uint64_t now = 0)
+            : m_now{now}
+        {
+        }
+
+        /**
+         * @brief Schedules value to be expired once wheel is advanced to `deadline`. Deadlines in the past expire on the next tick.
+         */
+        void Schedule(uint64_t deadline, T value)
+        {
+            ++m_size;
+            Place(Entry{.deadline = std::max(deadline, m_now + 1), .value = std::move(value)});
+        }
+
+        /**
+         * @brief Advances wheel up to `now` and invokes `on_expired` for every value with deadline <= now
+         */
+        template<std::invocable<T&&> Fn>
+        void Advance(uint64_t now, Fn&& on_expired)
+        {
+            while (m_now < now)
+            {
+                if (m_size == 0)
+                {
+                    m_now = now;
+                    return;
+                }
+
+                // nothing can expire or cascade before the next boundary of the lowest non-empty level
+                m_now = std::min(now - 1, m_now | LowestLevelMask());
+                ++m_now;
+                Cascade();
+
+                auto expired = std::exchange(m_wheels[0][m_now & mask], {});
+                m_size -= expired.size();
+                m_counts[0] -= expired.size();
+                for (auto& entry : expired)
+                    on_expired(std::move(entry.value));
+            }
+        }
+
+        uint64_t Now() const { return m_now; }
+        size_t   Size() const { return m_size; }
+
+    private:
+        struct Entry
+        {
+            uint64_t deadline;
+            T        value;
+        };
+
+        void Place(Entry&& entry)
+        {
+            const auto delta = entry.deadline - m_now;
+            for (size_t level = 0; level < levels; ++level)
+            {
+                if (delta < (uint64_t{1} << (bits * (level + 1))))
+                {
+                    ++m_counts[level];
+                    m_wheels[level][(entry.deadline >> (bits * level)) & mask].push_back(std::move(entry));
+                    return;
+                }
+            }
+            ++m_counts[levels];
+            m_overflow.push_back(std::move(entry));
+        }
+
+        uint64_t LowestLevelMask() const
+        {
+            for (size_t level = 0; level < levels; ++level)
+            {
+                if (m_counts[level] != 0)
+                    return (uint64_t{1} << (bits * level)) - 1;
+            }
+            return (uint64_t{1} << (bits * levels)) - 1;
+        }
+
+        void Cascade()
+        {
+            if ((m_now & ((uint64_t{1} << (bits * levels)) - 1)) == 0)
+                Replace(levels, m_overflow);
+
+            for (size_t level = levels - 1; level > 0; --level)
+            {
+                if ((m_now & ((uint64_t{1} << (bits * level)) - 1)) == 0)
+                    Replace(level, m_wheels[level][(m_now >> (bits * level)) & mask]);
+            }
+        }
+
+        void Replace(size_t level, std::vector<Entry>& entries)
+        {
+            m_counts[level] -= entries.size();
+            for (auto& entry : std::exchange(entries, {}))
+                Place(std::move(entry));
+        }
+
+    private:
+        std::array<std::array<std::vector<Entry>, slots>, levels> m_wheels{};
+        std::vector<Entry>                                        m_overflow{};
+        std::array<size_t, levels + 1>                            m_counts{};
+        uint64_t                                                  m_now;
+        size_t                                                    m_size{};
+    };
+} // namespace utils
@@ -0,0 +1,59 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/utils/bloom_filter.hpp>
+
+#include <cstdint>
+
+TEST_CASE("BloomFilter has no false negatives")
+{
+    constexpr uint64_t capacity = 10'000;
+
+    utils::BloomFilter filter{capacity};
+    REQUIRE(!filter.MayContain(0));
+
+    for (uint64_t i = 0; i < capacity; ++i)
+        filter.Insert(i);
+    for (uint64_t i = 0; i < capacity; ++i)
+        REQUIRE(filter.MayContain(i));
+
+    SUBCASE("false positives are rare")
+    {
+        constexpr uint64_t probes = 10 * capacity;
+
+        size_t false_positives = 0;
+        for (uint64_t i = capacity; i < capacity + probes; ++i)
+            false_positives += filter.MayContain(i) ? 1 : 0;
+        REQUIRE(false_positives < probes / 50);
+    }
+
+    SUBCASE("clear")
+    {
+        filter.Clear();
+        for (uint64_t i = 0; i < capacity; ++i)
+            REQUIRE(!filter.MayContain(i));
+    }
+}
+
+TEST_CASE("BloomFilter of zero capacity still works")
+{
+    utils::BloomFilter filter{0};
+    filter.Insert(42);
+    REQUIRE(filter.MayContain(42));
+}
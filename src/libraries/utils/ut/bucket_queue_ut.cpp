@@ -0,0 +1,118 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/utils/bucket_queue.hpp>
+
+#include <vector>
+
+TEST_CASE("BucketQueue pops highest priority first")
+{
+    utils::BucketQueue<int> queue{8};
+    REQUIRE(!queue.TryPop().has_value());
+
+    REQUIRE(queue.TryPush(1, 0));
+    REQUIRE(queue.TryPush(2, 255));
+    REQUIRE(queue.TryPush(3, 64));
+    REQUIRE(queue.TryPush(4, 63));
+    REQUIRE(queue.TryPush(5, 255));
+    REQUIRE(queue.TryPush(6, 0));
+    REQUIRE(queue.Size() == 6);
+
+    std::vector<int> popped{};
+    while (const auto value = queue.TryPop())
+        popped.push_back(value.value());
+    REQUIRE(popped == std::vector{2, 5, 3, 4, 1, 6});
+    REQUIRE(queue.Size() == 0);
+
+    SUBCASE("emptied bucket is refilled")
+    {
+        REQUIRE(queue.TryPush(7, 255));
+        REQUIRE(queue.TryPush(8, 1));
+        REQUIRE(queue.TryPop() == 7);
+        REQUIRE(queue.TryPop() == 8);
+    }
+}
+
+TEST_CASE("BucketQueue is bounded by capacity")
+{
+    utils::BucketQueue<int> queue{3};
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(queue.TryPush(i, static_cast<uint8_t>(i)));
+
+    REQUIRE(!queue.TryPush(3, 255));
+    REQUIRE(queue.TryPop() == 2);
+    REQUIRE(queue.TryPush(3, 255));
+    REQUIRE(queue.Size() == queue.Capacity());
+}
+
+TEST_CASE("BucketQueue doesn't count stale values")
+{
+    utils::BucketQueue<int> queue{3};
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(queue.TryPush(i, 0));
+
+    // Value 1 is gone for the owner
+    queue.MarkStale();
+    REQUIRE(queue.Size() == 2);
+    REQUIRE(queue.TryPush(3, 0));
+    REQUIRE(!queue.TryPush(4, 0));
+
+    SUBCASE("stale value is dropped once popped")
+    {
+        REQUIRE(queue.TryPop() == 0);
+        REQUIRE(queue.TryPop() == 1);
+        queue.DropStale();
+        REQUIRE(queue.Size() == 2);
+        REQUIRE(queue.TryPop() == 2);
+        REQUIRE(queue.TryPop() == 3);
+        REQUIRE(queue.Size() == 0);
+    }
+
+    SUBCASE("stale values are erased")
+    {
+        queue.EraseStale([](int value) { return value == 1; });
+        REQUIRE(queue.Size() == 3);
+        REQUIRE(queue.TryPop() == 0);
+        REQUIRE(queue.TryPop() == 2);
+        REQUIRE(queue.TryPop() == 3);
+        REQUIRE(!queue.TryPop().has_value());
+    }
+}
+
+TEST_CASE("BucketQueue asks to erase stale values once they outnumber live ones")
+{
+    constexpr int count = 1000;
+
+    utils::BucketQueue<int> queue{count};
+    for (int i = 0; i < count; ++i)
+        REQUIRE(queue.TryPush(i, static_cast<uint8_t>(i % 2)));
+
+    size_t stale = 0;
+    while (!queue.HasManyStale())
+    {
+        queue.MarkStale();
+        ++stale;
+    }
+    REQUIRE(stale == size_t{count} / 2 + 1);
+
+    queue.EraseStale([](int value) { return value % 2 == 0 || value < 2; });
+    REQUIRE(!queue.HasManyStale());
+    REQUIRE(queue.Size() == size_t{count} - stale);
+    REQUIRE(queue.TryPop() == 3);
+}
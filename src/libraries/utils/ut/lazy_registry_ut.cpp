@@ -0,0 +1,94 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+#include <doctest/doctest.h>
+
+#include <libraries/utils/lazy_registry.hpp>
+
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("LazyRegistry creates value once per key")
+{
+    utils::LazyRegistry<std::string> registry{2};
+    REQUIRE(registry.Find("a") == nullptr);
+
+    size_t      created = 0;
+    const auto& a       = registry.GetOrCreate("a", [&] { return std::to_string(++created); });
+    REQUIRE(a == "1");
+    REQUIRE(&registry.GetOrCreate("a", [&] { return std::to_string(++created); }) == &a);
+    REQUIRE(registry.Find("a") == &a);
+    REQUIRE(created == 1);
+
+    const auto& b = registry.GetOrCreate("b", [&] { return std::to_string(++created); });
+    REQUIRE(b == "2");
+    REQUIRE(registry.Size() == 2);
+
+    SUBCASE("registry is bounded")
+    {
+        REQUIRE_THROWS_AS(registry.GetOrCreate("c", [] { return std::string{}; }), std::length_error);
+        REQUIRE(registry.Find("c") == nullptr);
+        REQUIRE(registry.Find("a") == &a);
+    }
+
+    SUBCASE("for each")
+    {
+        std::map<std::string, std::string> values{};
+        registry.ForEach([&](std::string_view key, const std::string& value) { values.emplace(key, value); });
+        REQUIRE(values == std::map<std::string, std::string>{{"a", "1"}, {"b", "2"}});
+    }
+
+    SUBCASE("failed factory creates nothing")
+    {
+        utils::LazyRegistry<std::string> other{2};
+        REQUIRE_THROWS_AS(other.GetOrCreate("a", []() -> std::string { throw std::runtime_error("failed"); }), std::runtime_error);
+        REQUIRE(other.Size() == 0);
+        REQUIRE(other.GetOrCreate("a", [] { return std::string{"a"}; }) == "a");
+    }
+}
+
+TEST_CASE("LazyRegistry hands every thread the same value")
+{
+    constexpr size_t threads_count = 8;
+    constexpr size_t keys_count    = 64;
+
+    utils::LazyRegistry<size_t> registry{keys_count};
+    std::atomic_size_t          created{};
+
+    std::vector<std::vector<const size_t*>> seen(threads_count);
+    {
+        std::vector<std::jthread> threads{};
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&, i] {
+                for (size_t key = 0; key < keys_count; ++key)
+                    seen[i].push_back(&registry.GetOrCreate(std::to_string((key + i) % keys_count), [&] { return created++; }));
+            });
+        }
+    }
+
+    REQUIRE(created == keys_count);
+    REQUIRE(registry.Size() == keys_count);
+    for (size_t i = 0; i < threads_count; ++i)
+    {
+        for (size_t key = 0; key < keys_count; ++key)
+            REQUIRE(seen[i][key] == registry.Find(std::to_string((key + i) % keys_count)));
+    }
+}
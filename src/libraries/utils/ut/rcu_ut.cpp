@@ -0,0 +1,128 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/utils/rcu.hpp>
+
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Tracked
+    {
+        explicit Tracked(size_t& destroyed)
+            : destroyed{destroyed}
+        {
+        }
+        ~Tracked() { ++destroyed; }
+
+        size_t& destroyed;
+    };
+
+    struct Node
+    {
+        ~Node() { alive.store(false); }
+
+        std::atomic_bool alive{true};
+    };
+} // namespace
+
+TEST_CASE("Rcu destroys retired objects once readers are gone")
+{
+    size_t     destroyed{};
+    utils::Rcu rcu{};
+
+    SUBCASE("without readers")
+    {
+        rcu.Retire(new Tracked{destroyed});
+        REQUIRE(rcu.TryReclaim());
+        REQUIRE(destroyed == 0);
+        REQUIRE(rcu.TryReclaim());
+        REQUIRE(destroyed == 1);
+    }
+
+    SUBCASE("active reader postpones destruction")
+    {
+        std::optional<std::jthread> reader{};
+        std::atomic_bool            entered{};
+        std::atomic_bool            leave{};
+        reader.emplace([&] {
+            const auto guard = rcu.Read();
+            entered          = true;
+            while (!leave)
+                std::this_thread::yield();
+        });
+        while (!entered)
+            std::this_thread::yield();
+
+        rcu.Retire(new Tracked{destroyed});
+        REQUIRE(rcu.TryReclaim());
+        REQUIRE(!rcu.TryReclaim());
+        REQUIRE(!rcu.TryReclaim());
+        REQUIRE(destroyed == 0);
+
+        leave = true;
+        reader.reset();
+        REQUIRE(rcu.TryReclaim());
+        REQUIRE(destroyed == 1);
+    }
+
+    SUBCASE("destructor destroys everything")
+    {
+        {
+            utils::Rcu local{};
+            local.Retire(new Tracked{destroyed});
+            local.Retire(new Tracked{destroyed});
+        }
+        REQUIRE(destroyed == 2);
+    }
+}
+
+TEST_CASE("Rcu readers never observe destroyed objects")
+{
+    constexpr size_t readers_count = 4;
+    constexpr size_t updates       = 100'000;
+
+    utils::Rcu         rcu{};
+    std::atomic<Node*> current{new Node{}};
+    std::atomic_bool   done{};
+    std::atomic_size_t failures{};
+    {
+        std::vector<std::jthread> readers{};
+        for (size_t i = 0; i < readers_count; ++i)
+        {
+            readers.emplace_back([&] {
+                while (!done)
+                {
+                    const auto guard = rcu.Read();
+                    if (!current.load(std::memory_order_acquire)->alive)
+                        ++failures;
+                }
+            });
+        }
+
+        for (size_t i = 0; i < updates; ++i)
+            rcu.Retire(current.exchange(new Node{}, std::memory_order_acq_rel));
+        done = true;
+    }
+    delete current.load();
+    REQUIRE(failures == 0);
+}
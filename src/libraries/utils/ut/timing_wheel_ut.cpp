@@ -0,0 +1,89 @@
+// Copyright (C) 2024-2025 Aleksey Loginov
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Home page: https://github.com/Just-Queue-it/JustQueueIt/
+
+#include <doctest/doctest.h>
+
+#include <libraries/utils/timing_wheel.hpp>
+
+#include <map>
+#include <vector>
+
+TEST_CASE("TimingWheel expires values exactly at deadline")
+{
+    constexpr uint64_t start = 1000;
+
+    utils::TimingWheel<uint64_t> wheel{start};
+
+    const std::vector<uint64_t> deadlines{start + 1, start + 255, start + 256, start + 257, start + 70'000, start + 20'000'000, start + (uint64_t{1} << 33)};
+    for (const auto deadline : deadlines)
+        wheel.Schedule(deadline, deadline);
+    REQUIRE(wheel.Size() == deadlines.size());
+
+    std::map<uint64_t, uint64_t> fired_at{};
+    const auto                   advance = [&](uint64_t now) {
+        wheel.Advance(now, [&](uint64_t&& value) { fired_at[value] = wheel.Now(); });
+    };
+
+    SUBCASE("tick by tick")
+    {
+        for (const auto deadline : deadlines)
+        {
+            if (deadline > start + 100'000'000)
+                break;
+
+            advance(deadline - 1);
+            REQUIRE(!fired_at.contains(deadline));
+            advance(deadline);
+            REQUIRE(fired_at.at(deadline) == deadline);
+        }
+    }
+
+    SUBCASE("single jump")
+    {
+        advance(start + (uint64_t{1} << 34));
+        REQUIRE(fired_at.size() == deadlines.size());
+        for (const auto deadline : deadlines)
+            REQUIRE(fired_at.at(deadline) == deadline);
+        REQUIRE(wheel.Size() == 0);
+    }
+}
+
+TEST_CASE("TimingWheel handles past deadlines and rescheduling")
+{
+    utils::TimingWheel<int> wheel{10};
+
+    std::vector<int> fired{};
+    wheel.Schedule(5, 1);
+    wheel.Advance(10, [&](int&& v) { fired.push_back(v); });
+    REQUIRE(fired.empty());
+
+    wheel.Advance(11, [&](int&& v) {
+        fired.push_back(v);
+        wheel.Schedule(13, v + 1);
+    });
+    REQUIRE(fired == std::vector{1});
+
+    wheel.Advance(20, [&](int&& v) { fired.push_back(v); });
+    REQUIRE(fired == std::vector{1, 2});
+    REQUIRE(wheel.Size() == 0);
+
+    SUBCASE("empty wheel jumps forward")
+    {
+        wheel.Advance(1'000'000'000, [&](int&&) {});
+        REQUIRE(wheel.Now() == 1'000'000'000);
+    }
+}